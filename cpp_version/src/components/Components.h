@@ -1,6 +1,8 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "../managers/ResourceHandles.h"
 #include <string>
+#include <type_traits>
 
 // Pure ECS Components (Data Only)
 
@@ -13,6 +15,15 @@ struct Transform
         : x(x), y(y), rotation(rotation) {}
 };
 
+// Transform position at the start of the current simulation tick; rendering
+// interpolates from here to Transform by the leftover fraction of a tick
+struct PreviousTransform
+{
+    float x, y;
+
+    PreviousTransform(float x = 0, float y = 0) : x(x), y(y) {}
+};
+
 struct Velocity
 {
     float x, y;
@@ -22,15 +33,15 @@ struct Velocity
 
 struct Sprite
 {
-    SDL_Texture *texture;
+    TextureHandle texture; // Whole-texture fallback when the sprite type has no clip
     int width, height;
     int frameCount;
     float frameTime;
     bool animated;
-    std::string currentTexturePath; // Track currently loaded texture
+    int spriteTypeId; // Index into ResourceManager's animation clip tables (-1 = static texture)
 
-    Sprite(SDL_Texture *tex = nullptr, int w = 0, int h = 0, int frames = 1, float fTime = 0.1f)
-        : texture(tex), width(w), height(h), frameCount(frames), frameTime(fTime), animated(frames > 1), currentTexturePath("") {}
+    Sprite(TextureHandle tex = TextureHandle(), int w = 0, int h = 0, int frames = 1, float fTime = 0.1f, int typeId = -1)
+        : texture(tex), width(w), height(h), frameCount(frames), frameTime(fTime), animated(frames > 1), spriteTypeId(typeId) {}
 };
 
 struct Collider
@@ -58,24 +69,27 @@ struct Animation
         : currentFrame(frame), animationTimer(timer) {}
 };
 
+// Interned type name (see EntityTypeRegistry)
+using EntityTypeId = Uint16;
+constexpr EntityTypeId INVALID_ENTITY_TYPE = 0xFFFF;
+
 struct EntityType
 {
-    std::string type;
+    EntityTypeId id;
 
-    EntityType(const std::string &t = "") : type(t) {}
+    EntityType(EntityTypeId id = INVALID_ENTITY_TYPE) : id(id) {}
 };
 
 struct UIText
 {
     std::string content;
-    std::string fontPath;
-    int fontSize;
+    FontHandle font; // A (font file, size) pair loaded by ResourceManager
     SDL_Color color;
     bool visible;
 
-    UIText(const std::string &text = "", const std::string &font = "", int size = 24,
+    UIText(const std::string &text = "", FontHandle font = FontHandle(),
            SDL_Color col = {255, 255, 255, 255}, bool vis = true)
-        : content(text), fontPath(font), fontSize(size), color(col), visible(vis) {}
+        : content(text), font(font), color(col), visible(vis) {}
 };
 
 struct UIPosition
@@ -104,3 +118,7 @@ struct MovementDirection
 
     MovementDirection(Direction dir = HORIZONTAL) : direction(dir) {}
 };
+
+// Plain-data components, copyable with memcpy (e.g. into dormant chunk records)
+static_assert(std::is_trivially_copyable<Sprite>::value, "Sprite must be trivially copyable");
+static_assert(std::is_trivially_copyable<EntityType>::value, "EntityType must be trivially copyable");
@@ -0,0 +1,35 @@
+#pragma once
+#include "ECS.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+// Screen-sized view into a world that may be many screens large. The view
+// follows a target entity and is clamped so it never shows past the world edge.
+class Camera
+{
+private:
+    float viewWidth, viewHeight;
+    float worldWidth, worldHeight;
+    float x, y; // Top-left corner of the view in world space
+    EntityID target;
+
+public:
+    Camera(float viewW = 0, float viewH = 0, float worldW = 0, float worldH = 0)
+        : viewWidth(viewW), viewHeight(viewH), worldWidth(std::max(worldW, viewW)),
+          worldHeight(std::max(worldH, viewH)), x(0), y(0), target(0) {}
+
+    void setTarget(EntityID entityID) { target = entityID; }
+    EntityID getTarget() const { return target; }
+
+    void centerOn(float centerX, float centerY)
+    {
+        x = std::clamp(centerX - viewWidth / 2.0f, 0.0f, worldWidth - viewWidth);
+        y = std::clamp(centerY - viewHeight / 2.0f, 0.0f, worldHeight - viewHeight);
+    }
+
+    SDL_FRect getView() const { return {x, y, viewWidth, viewHeight}; }
+    float getCenterX() const { return x + viewWidth / 2.0f; }
+    float getCenterY() const { return y + viewHeight / 2.0f; }
+    float getWorldWidth() const { return worldWidth; }
+    float getWorldHeight() const { return worldHeight; }
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "../components/Components.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Interning table for entity type names from entities.json ("player", mob and UI
+// element names). Names are mapped to small dense IDs once at load, so per-frame
+// code compares EntityType IDs instead of strings.
+class EntityTypeRegistry
+{
+private:
+    std::vector<std::string> names; // Indexed by ID
+    std::unordered_map<std::string, EntityTypeId> ids;
+
+public:
+    // ID of name, registering it on first use
+    EntityTypeId intern(const std::string &name)
+    {
+        auto it = ids.find(name);
+        if (it != ids.end())
+            return it->second;
+
+        EntityTypeId id = static_cast<EntityTypeId>(names.size());
+        names.push_back(name);
+        ids[name] = id;
+        return id;
+    }
+
+    // ID of an interned name, or INVALID_ENTITY_TYPE
+    EntityTypeId find(const std::string &name) const
+    {
+        auto it = ids.find(name);
+        return it != ids.end() ? it->second : INVALID_ENTITY_TYPE;
+    }
+
+    const std::string &getName(EntityTypeId id) const
+    {
+        static const std::string unknown = "<unknown>";
+        return id < names.size() ? names[id] : unknown;
+    }
+
+    size_t size() const { return names.size(); }
+};
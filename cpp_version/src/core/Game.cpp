@@ -1,11 +1,30 @@
 #include "Game.h"
+#include "Profiler.h"
 #include "../systems/Systems.h"
 #include "../managers/ResourceManager.h"
 #include "../managers/EntityFactory.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
-Game::Game()
-    : window(nullptr), renderer(nullptr), running(false), playerEntityID(0) {}
+namespace
+{
+    float secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+Game::Game(const GameOptions &options)
+    : options(options), window(nullptr), renderer(nullptr), offscreenSurface(nullptr),
+      running(false), frameCount(0), uploadBudgetMs(2.0f), fixedDeltaTime(1.0f / 60.0f), maxCatchUpSteps(5),
+      tickAccumulator(0.0f), simulatedFrames(0), totalSpritesDrawn(0), totalSpritesCulled(0), simulationPending(false),
+      simulationStopping(false), simulationDeltaTime(0.0f), simulationFPS(0.0f), simulationPacingError(0.0f),
+      simulateSeconds(0.0f), uiSeconds(0.0f), presentedHash(0), idle(false), forceRedraw(true),
+      playerEntityID(0), scoreDisplayType(INVALID_ENTITY_TYPE), fpsDisplayType(INVALID_ENTITY_TYPE),
+      frameTimeDisplayType(INVALID_ENTITY_TYPE), gameMessageType(INVALID_ENTITY_TYPE) {}
 
 Game::~Game()
 {
@@ -14,53 +33,143 @@ Game::~Game()
 
 bool Game::initialize()
 {
+    // With --profile, loading is in the trace too
+    Profiler::setThreadName("Main");
+    Profiler::setEnabled(!options.profilePath.empty());
+
     if (!initializeSDL())
     {
         return false;
     }
 
-    // Initialize resource manager
-    resourceManager = std::make_unique<ResourceManager>(renderer);
-
-    // Initialize entity factory
-    entityFactory = std::make_unique<EntityFactory>(resourceManager.get());
-
-    // Load entity configuration
+    // Load entity configuration first: it sizes the window and the headless surface
+    entityFactory = std::make_unique<EntityFactory>();
     if (!entityFactory->loadConfig("entities.json"))
     {
         std::cerr << "Failed to load entity configuration" << std::endl;
         return false;
     }
 
+    // Resolve the UI types updateUI() looks for once, so per-frame checks compare IDs
+    scoreDisplayType = entityFactory->getTypeId("scoreDisplay");
+    fpsDisplayType = entityFactory->getTypeId("fpsDisplay");
+    frameTimeDisplayType = entityFactory->getTypeId("frameTimeDisplay");
+    gameMessageType = entityFactory->getTypeId("gameMessage");
+
     // Load game settings from JSON
     json gameSettings = entityFactory->getGameSettings();
     gameManager.screenWidth = gameSettings["screenSize"]["width"].get<float>();
     gameManager.screenHeight = gameSettings["screenSize"]["height"].get<float>();
     gameManager.mobSpawnInterval = gameSettings["mobSpawnInterval"].get<float>();
     gameManager.scorePerSecond = gameSettings["scorePerSecond"].get<float>();
+    uploadBudgetMs = gameSettings.value("uploadBudgetMs", 2.0f);
+
+    if (!createRenderer())
+    {
+        return false;
+    }
+
+    // Initialize resource manager (the CPU backend samples textures from retained pixels)
+    resourceManager = std::make_unique<ResourceManager>(renderer, options.loaderThreads);
+    resourceManager->setRetainPixels(options.headless);
+    resourceManager->setTextureBudget(static_cast<size_t>(gameSettings.value("textureBudgetMB", 256.0f) * 1024.0f * 1024.0f));
+    entityFactory->setResourceManager(resourceManager.get());
+    std::cout << "Asset loader: " << resourceManager->getLoaderThreadCount() << " decode threads" << std::endl;
+
+    // Optional pre-decoded bundle: one mapped file instead of decoding loose assets
+    if (!options.bundlePath.empty())
+    {
+        assetBundle = std::make_unique<AssetBundle>();
+        if (!assetBundle->open(options.bundlePath))
+        {
+            std::cerr << "Failed to load asset bundle" << std::endl;
+            return false;
+        }
+        resourceManager->setBundle(assetBundle.get());
+        std::cout << "Asset bundle: " << options.bundlePath << " (" << assetBundle->getEntryCount()
+                  << " assets, " << assetBundle->getSize() / 1024 << " KiB mapped)" << std::endl;
+    }
+
+    // World is the screen unless gameSettings.world makes it larger; it is streamed in chunks
+    json world = gameSettings.value("world", json::object());
+    gameManager.worldWidth = std::max(world.value("width", gameManager.screenWidth), gameManager.screenWidth);
+    gameManager.worldHeight = std::max(world.value("height", gameManager.screenHeight), gameManager.screenHeight);
+    float worldChunkSize = world.value("chunkSize", 480.0f);
+    int worldActiveRadius = world.value("activeRadius", 2);
+    size_t worldMaxDormantPerChunk = world.value("maxDormantPerChunk", 32);
+    camera = Camera(gameManager.screenWidth, gameManager.screenHeight,
+                    gameManager.worldWidth, gameManager.worldHeight);
+
+    // Simulation tick rate and how many ticks one frame may run to catch up after a hitch
+    int tickRate = options.tickRate > 0 ? options.tickRate
+                                        : gameSettings.value("tickRate", 60);
+    fixedDeltaTime = 1.0f / static_cast<float>(std::max(tickRate, 1));
+    maxCatchUpSteps = std::max(gameSettings.value("maxCatchUpSteps", 5), 1);
+
+    // Initialize audio system; its files load on their own thread from here on
+    audioSystem = std::make_unique<AudioSystem>(createAudioBackend());
+    audioSystem->setBundle(assetBundle.get());
+    if (!audioSystem->initialize())
+    {
+        std::cerr << "Failed to initialize audio system" << std::endl;
+        return false;
+    }
+    std::cout << "Audio backend: " << audioSystem->getBackend()->getName();
+    if (audioSystem->getMusicBufferBytes() > 0)
+        std::cout << " (music streamed through " << audioSystem->getMusicBufferBytes() / 1024 << " KiB of buffers)";
+    std::cout << std::endl;
+    startAudioLoad();
+
+    // Pack sprite frames into atlas pages before any entity references them
+    if (!loadAssets())
+    {
+        std::cerr << "Failed to load sprite assets" << std::endl;
+        return false;
+    }
 
     // Initialize systems
-    timingSystem = std::make_unique<TimingSystem>();
+    initializePacing();
     inputSystem = std::make_unique<InputSystem>();
     movementSystem = std::make_unique<MovementSystem>();
     animationSystem = std::make_unique<AnimationSystem>();
-    audioSystem = std::make_unique<AudioSystem>();
-    mobSpawningSystem = std::make_unique<MobSpawningSystem>(entityFactory.get(),
-                                                            gameManager.screenWidth,
-                                                            gameManager.screenHeight);
+    mobSpawningSystem = std::make_unique<MobSpawningSystem>(entityFactory.get(), &camera);
     collisionSystem = std::make_unique<CollisionSystem>(audioSystem.get());
-    boundarySystem = std::make_unique<BoundarySystem>(gameManager.screenWidth,
-                                                      gameManager.screenHeight);
-    renderSystem = std::make_unique<RenderSystem>(renderer, resourceManager.get());
+    boundarySystem = std::make_unique<BoundarySystem>(gameManager.worldWidth,
+                                                      gameManager.worldHeight);
+    chunkStreamingSystem = std::make_unique<ChunkStreamingSystem>(&camera, worldChunkSize, worldActiveRadius,
+                                                                  worldMaxDormantPerChunk);
+    std::unique_ptr<RenderBackend> renderBackend;
+    if (options.headless)
+    {
+        renderBackend = std::make_unique<CPURenderBackend>(resourceManager.get(),
+                                                           static_cast<int>(gameManager.screenWidth),
+                                                           static_cast<int>(gameManager.screenHeight),
+                                                           options.dumpFramesDir,
+                                                           options.renderThreads);
+    }
+    else
+    {
+        renderBackend = std::make_unique<SDLRenderBackend>(renderer);
+    }
+    std::cout << "Render backend: " << renderBackend->getName();
+    if (auto *cpuBackend = dynamic_cast<CPURenderBackend *>(renderBackend.get()))
+    {
+        std::cout << " (" << cpuBackend->getThreadCount() << " compositing threads)";
+    }
+    std::cout << std::endl;
+    renderSystem = std::make_unique<RenderSystem>(renderer, resourceManager.get(), std::move(renderBackend));
+    renderSystem->setCenteredTextType(gameMessageType);
 
-    // Initialize audio system
-    if (!audioSystem->initialize())
+    // Dynamic resolution: render the world below native resolution when over the frame budget
+    if (gameSettings.contains("dynamicResolution"))
     {
-        std::cerr << "Failed to initialize audio system" << std::endl;
-        return false;
+        json dynamicResolution = gameSettings["dynamicResolution"];
+        renderSystem->configureResolutionScaling(dynamicResolution.value("enabled", false),
+                                                 dynamicResolution.value("minScale", 0.5f),
+                                                 dynamicResolution.value("step", 0.1f));
     }
 
-    // Load audio assets
+    // Load audio assets (waits for the audio loader)
     if (!loadAudioAssets())
     {
         std::cerr << "Failed to load audio assets" << std::endl;
@@ -69,6 +178,22 @@ bool Game::initialize()
 
     // Create initial entities
     createInitialEntities();
+    camera.setTarget(playerEntityID);
+    updateCamera();
+
+    if (options.autoStart)
+    {
+        gameManager.startGame();
+    }
+
+    // Prime the pipeline so the first rendered frame already has a snapshot
+    updateUI(0.0f, 0.0f, FrameTimeSummary());
+    publishSnapshot(1.0f);
+
+    if (options.pipelined)
+    {
+        simulationThread = std::thread(&Game::simulationLoop, this);
+    }
 
     running = true;
     return true;
@@ -78,19 +203,102 @@ void Game::run()
 {
     while (running)
     {
-        handleEvents();
         gameLoop();
     }
+
+    if (!options.profilePath.empty())
+    {
+        if (Profiler::writeTrace(options.profilePath, options.profileSeconds))
+            std::cout << "Profile: last " << options.profileSeconds << " s written to " << options.profilePath
+                      << std::endl;
+        else
+            std::cerr << "Failed to write profile: " << options.profilePath << std::endl;
+    }
+
+    if (simulatedFrames > 0)
+    {
+        std::cout << "Sprites per frame: " << totalSpritesDrawn / static_cast<double>(simulatedFrames)
+                  << " drawn, " << totalSpritesCulled / static_cast<double>(simulatedFrames)
+                  << " culled" << std::endl;
+    }
+
+    // Frame-time distribution, overall and per phase
+    FrameTimeSummary frames = timingSystem->getFrameTimeSummary();
+    if (frames.count > 0)
+    {
+        char line[160];
+        std::snprintf(line, sizeof(line),
+                      "Frame times (%llu frames): p50 %.2f ms, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f; "
+                      "%llu over the %.2f ms budget",
+                      static_cast<unsigned long long>(frames.count), frames.p50, frames.p90, frames.p99,
+                      frames.p999, frames.max, static_cast<unsigned long long>(frames.overBudget),
+                      timingSystem->getFrameBudget() * 1000.0f);
+        std::cout << line << std::endl;
+        for (int i = 0; i < static_cast<int>(FramePhase::COUNT); ++i)
+        {
+            FramePhase phase = static_cast<FramePhase>(i);
+            FrameTimeSummary times = timingSystem->getPhaseTimes(phase).getSummary();
+            if (times.count == 0)
+                continue;
+            std::snprintf(line, sizeof(line), "  %-9s p50 %6.2f  p90 %6.2f  p99 %6.2f  p99.9 %6.2f  max %6.2f ms",
+                          TimingSystem::getPhaseName(phase), times.p50, times.p90, times.p99, times.p999, times.max);
+            std::cout << line << std::endl;
+        }
+    }
+
+    const TextureCacheStats &textures = resourceManager->getTextureStats();
+    std::cout << "Textures: " << textures.residentTextures << " resident (" << textures.residentBytes / 1024
+              << " KiB";
+    if (textures.budgetBytes > 0)
+        std::cout << " of " << textures.budgetBytes / 1024 << " KiB budget";
+    std::cout << "), " << textures.hits << " hits, " << textures.misses << " misses, "
+              << textures.evictions << " evictions" << std::endl;
+    const AudioVoiceStats &voices = audioSystem->getVoiceStats();
+    std::cout << "Audio: " << voices.played << " sounds played, " << voices.coalesced << " coalesced, "
+              << voices.stolen << " voices stolen, " << voices.dropped << " dropped";
+    if (audioSystem->getDroppedCommandCount() > 0)
+        std::cout << ", " << audioSystem->getDroppedCommandCount() << " commands lost (queue full)";
+    if (voices.played > 0)
+        std::cout << ", command latency " << voices.totalLatencyMs / voices.played << " ms avg / "
+                  << voices.maxLatencyMs << " ms max";
+    std::cout << std::endl;
+
+    if (auto *offline = dynamic_cast<OfflineAudioBackend *>(audioSystem->getBackend()))
+    {
+        double mixedSeconds = offline->getMixedSeconds();
+        double cpuSeconds = offline->getMixCpuSeconds();
+        std::cout << "Offline mix: " << mixedSeconds << " s of audio in " << cpuSeconds * 1000.0 << " ms CPU";
+        if (cpuSeconds > 0.0)
+            std::cout << " (" << mixedSeconds / cpuSeconds << "x real time)";
+        std::cout << ", peak " << offline->getPeak() << ", checksum " << std::hex << offline->getChecksum()
+                  << std::dec << std::endl;
+    }
 }
 
 void Game::shutdown()
 {
+    // The simulation thread touches the ECS and audio, so it goes first; the
+    // audio loader is still running if initialization failed part way
+    stopSimulationThread();
+    if (audioLoader.joinable())
+        audioLoader.join();
+
+    // Release GPU resources while the renderer still exists
+    renderSystem.reset();
+    resourceManager.reset();
+
     if (renderer)
     {
         SDL_DestroyRenderer(renderer);
         renderer = nullptr;
     }
 
+    if (offscreenSurface)
+    {
+        SDL_FreeSurface(offscreenSurface);
+        offscreenSurface = nullptr;
+    }
+
     if (window)
     {
         SDL_DestroyWindow(window);
@@ -104,6 +312,12 @@ void Game::shutdown()
 
 bool Game::initializeSDL()
 {
+    // Headless runs must not need a display server
+    if (options.headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
@@ -126,6 +340,36 @@ bool Game::initializeSDL()
         return false;
     }
 
+    return true;
+}
+
+bool Game::createRenderer()
+{
+    // Sized from gameSettings.screenSize, so this runs after the configuration loads
+    if (options.headless)
+    {
+        // Software renderer on an offscreen surface: textures stay valid SDL_Textures
+        // while the CPU backend does the actual compositing
+        offscreenSurface = SDL_CreateRGBSurfaceWithFormat(0,
+                                                          static_cast<int>(gameManager.screenWidth),
+                                                          static_cast<int>(gameManager.screenHeight),
+                                                          32, SDL_PIXELFORMAT_RGBA32);
+        if (!offscreenSurface)
+        {
+            std::cerr << "Offscreen surface could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        renderer = SDL_CreateSoftwareRenderer(offscreenSurface);
+        if (!renderer)
+        {
+            std::cerr << "Software renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
     // Create window
     window = SDL_CreateWindow("Dodge the Creeps",
                               SDL_WINDOWPOS_UNDEFINED,
@@ -140,8 +384,13 @@ bool Game::initializeSDL()
         return false;
     }
 
-    // Create renderer
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Create renderer (present blocks on the display refresh in vsync mode)
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    if (options.pacing == PacingMode::VSYNC)
+    {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer)
     {
         std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
@@ -151,16 +400,104 @@ bool Game::initializeSDL()
     return true;
 }
 
-bool Game::loadAudioAssets()
+std::unique_ptr<AudioBackend> Game::createAudioBackend() const
 {
-    json fullConfig = entityFactory->getEntityConfig();
-    if (!fullConfig.contains("audio"))
+    // Headless runs mix offline by default: no device needed, and the output is reproducible
+    AudioOutput output = options.audio;
+    if (output == AudioOutput::AUTO)
+        output = options.headless ? AudioOutput::OFFLINE : AudioOutput::DEVICE;
+
+    switch (output)
     {
-        std::cerr << "No audio configuration found in entities.json" << std::endl;
-        return true; // Not critical, continue without audio
+    case AudioOutput::NONE:
+        return std::make_unique<NullAudioBackend>();
+    case AudioOutput::OFFLINE:
+        return std::make_unique<OfflineAudioBackend>(options.dumpAudioPath);
+    default:
+        return std::make_unique<SDLAudioBackend>();
     }
+}
 
-    json audio = fullConfig["audio"];
+void Game::initializePacing()
+{
+    PacingMode pacing = options.headless ? PacingMode::UNLOCKED : options.pacing;
+    float targetFPS = options.targetFPS;
+
+    if (pacing == PacingMode::VSYNC)
+    {
+        // Target the display refresh so pacing error is measured against it
+        SDL_DisplayMode displayMode;
+        if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &displayMode) == 0 &&
+            displayMode.refresh_rate > 0)
+        {
+            targetFPS = static_cast<float>(displayMode.refresh_rate);
+        }
+
+        // Drivers may ignore the vsync request; pace ourselves at the refresh rate then
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) != 0 || !(info.flags & SDL_RENDERER_PRESENTVSYNC))
+        {
+            std::cerr << "VSync not available, falling back to fixed pacing" << std::endl;
+            pacing = PacingMode::FIXED;
+        }
+    }
+
+    timingSystem = std::make_unique<TimingSystem>(pacing, targetFPS);
+
+    std::cout << "Frame pacing: " << TimingSystem::getPacingModeName(pacing);
+    if (pacing != PacingMode::UNLOCKED)
+    {
+        std::cout << " at " << targetFPS << " Hz";
+    }
+    std::cout << std::endl;
+}
+
+bool Game::loadAssets()
+{
+    // UI fonts open and rasterise on the font loader while the image batch decodes
+    json uiConfig = entityFactory->getEntityConfig().value("ui", json::object());
+    std::vector<std::pair<std::string, int>> uiFonts;
+    for (auto &[name, element] : uiConfig.items())
+    {
+        if (element.contains("font") && element.contains("fontSize"))
+            uiFonts.emplace_back(element["font"].get<std::string>(), element["fontSize"].get<int>());
+    }
+    resourceManager->startFontPreload(uiFonts);
+
+    std::vector<std::string> framePaths = entityFactory->getSpriteFramePaths();
+    if (!resourceManager->buildSpriteAtlas(framePaths))
+    {
+        // Not fatal: RenderSystem falls back to individual textures
+        std::cerr << "Sprite atlas could not be built, using individual textures" << std::endl;
+    }
+
+    // Resolve animation clips to atlas regions once so rendering never touches paths
+    if (!entityFactory->registerSpriteClips())
+    {
+        std::cerr << "Some sprite animation clips could not be resolved" << std::endl;
+    }
+
+    // Upload UI glyph atlases now rather than on the first rendered frame
+    resourceManager->finishFontPreload();
+    for (const auto &[path, size] : uiFonts)
+    {
+        resourceManager->getGlyphAtlas(entityFactory->resolveFont(path, size));
+    }
+
+    return true;
+}
+
+void Game::startAudioLoad()
+{
+    json fullConfig = entityFactory->getEntityConfig();
+    if (fullConfig.contains("audio"))
+        audioLoader = std::thread(&Game::loadAudioFiles, this, fullConfig["audio"]);
+}
+
+void Game::loadAudioFiles(json audio)
+{
+    Profiler::setThreadName("Audio loader");
+    PROFILE_ZONE("Load audio");
 
     // Load background music
     if (audio.contains("backgroundMusic"))
@@ -175,6 +512,21 @@ bool Game::loadAudioAssets()
         }
     }
 
+    // Additional music tracks
+    if (audio.contains("music"))
+    {
+        for (auto &[key, track] : audio["music"].items())
+        {
+            std::string name = track["name"].get<std::string>();
+            std::string file = track["file"].get<std::string>();
+
+            if (!audioSystem->loadMusic(name, file))
+            {
+                std::cerr << "Failed to load music: " << file << std::endl;
+            }
+        }
+    }
+
     // Load sound effects
     if (audio.contains("soundEffects"))
     {
@@ -182,18 +534,58 @@ bool Game::loadAudioAssets()
         {
             std::string name = sfx["name"].get<std::string>();
             std::string file = sfx["file"].get<std::string>();
+            int maxVoices = sfx.value("maxVoices", AudioSystem::DEFAULT_MAX_VOICES_PER_SOUND);
+            Uint8 priority = static_cast<Uint8>(std::max(0, std::min(255, sfx.value("priority", 0))));
 
-            if (!audioSystem->loadSoundEffect(name, file))
+            if (!audioSystem->loadSoundEffect(name, file, maxVoices, priority).isValid())
             {
                 std::cerr << "Failed to load sound effect: " << file << std::endl;
             }
         }
     }
+}
+
+bool Game::loadAudioAssets()
+{
+    // Sounds and music were loaded alongside the images; wait for the last of them
+    if (audioLoader.joinable())
+        audioLoader.join();
+
+    json fullConfig = entityFactory->getEntityConfig();
+    if (!fullConfig.contains("audio"))
+    {
+        std::cerr << "No audio configuration found in entities.json" << std::endl;
+        return true; // Not critical, continue without audio
+    }
+
+    json audio = fullConfig["audio"];
+
+    // Track per game state (by default only gameplay has music)
+    audioSystem->setStateMusic(GameManager::PLAYING, audioSystem->findMusic("background"));
+    if (audio.contains("stateMusic"))
+    {
+        json stateMusic = audio["stateMusic"];
+        const std::pair<const char *, GameManager::GameState> states[] = {
+            {"menu", GameManager::MENU}, {"playing", GameManager::PLAYING}, {"gameOver", GameManager::GAME_OVER}};
+        for (const auto &[key, state] : states)
+        {
+            if (stateMusic.contains(key))
+                audioSystem->setStateMusic(state, audioSystem->findMusic(stateMusic[key].get<std::string>()));
+        }
+    }
 
     // Set volume levels
     if (audio.contains("settings"))
     {
         json settings = audio["settings"];
+        if (settings.contains("voices"))
+        {
+            audioSystem->setVoiceCount(settings["voices"].get<int>());
+        }
+        if (settings.contains("crossfadeSeconds"))
+        {
+            audioSystem->setCrossfadeTime(settings["crossfadeSeconds"].get<float>());
+        }
         if (settings.contains("musicVolume"))
         {
             audioSystem->setMusicVolume(settings["musicVolume"].get<int>());
@@ -215,40 +607,306 @@ void Game::createInitialEntities()
     // Create UI entities
     entityFactory->createUIElement(ecs, "scoreDisplay");
     entityFactory->createUIElement(ecs, "fpsDisplay");
+    entityFactory->createUIElement(ecs, "frameTimeDisplay");
     entityFactory->createUIElement(ecs, "gameMessage");
 }
 
 void Game::gameLoop()
 {
+    PROFILE_ZONE("Frame");
+
     // 1. Update timing and calculate delta time
     float deltaTime = timingSystem->update();
+    float fps = timingSystem->getFPS();
+    float pacingError = timingSystem->getMaxPacingError();
+    const FrameTimeSummary &frameTimes = timingSystem->getRecentFrameTimes();
+
+    // Headless runs advance exactly one tick per frame so output is reproducible
+    if (options.headless)
+    {
+        deltaTime = fixedDeltaTime;
+    }
+
+    // 2. Poll events and sample input here: SDL keyboard state belongs to the event thread
+    auto inputStart = std::chrono::steady_clock::now();
+    {
+        PROFILE_ZONE("Input");
+        handleEvents();
+        inputSystem->captureKeyboardState();
+    }
+    timingSystem->recordPhase(FramePhase::INPUT, secondsSince(inputStart));
+    if (!running)
+        return;
+
+    if (options.pipelined && !idle)
+    {
+        // 3. Take the newest published snapshot before the next simulation step can publish
+        const RenderSnapshot *snapshot = snapshots.acquireLatest();
+
+        // 4. Simulate the next frame on the worker thread while this one renders
+        startSimulation(deltaTime, fps, pacingError, frameTimes);
+        idle = !presentSnapshot(snapshot);
+        PROFILE_ZONE("Wait for simulation");
+        waitForSimulation();
+    }
+    else
+    {
+        // Sequential, or waking from idle: simulate first so the input that woke
+        // us is on screen this frame rather than one frame later
+        simulateFrame(deltaTime, fps, pacingError, frameTimes);
+        idle = !presentSnapshot(snapshots.acquireLatest());
+    }
+    timingSystem->recordPhase(FramePhase::SIMULATE, simulateSeconds);
+    timingSystem->recordPhase(FramePhase::UI, uiSeconds);
 
-    // 2. Handle input
-    inputSystem->update(ecs, gameManager, deltaTime);
+    // Audio stage: play what the simulation queued this frame
+    {
+        PROFILE_ZONE("Audio");
+        audioSystem->processCommands();
+        audioSystem->advance(deltaTime);
+    }
+
+    // Turn decoded images into textures while the simulation is not reading clip tables
+    {
+        PROFILE_ZONE("Texture uploads");
+        resourceManager->processUploads(uploadBudgetMs);
+    }
+
+    // Feed the resolution scaler with this frame's work, excluding time blocked in present
+    if (!idle)
+    {
+        float workTime = timingSystem->getFrameElapsed() - renderSystem->getLastPresentTime();
+        renderSystem->reportFrameTime(workTime, timingSystem->getTargetFrameTime());
+        timingSystem->recordFrameWork(workTime);
+    }
 
-    // 3. Update game logic (only if playing)
+    // 5. Wait for the next frame deadline (no-op for vsync and unlocked pacing),
+    //    or for the next event when nothing on screen is changing
+    if (idle)
+    {
+        PROFILE_ZONE("Idle");
+        SDL_WaitEventTimeout(nullptr, IDLE_WAIT_MS);
+        timingSystem->resumeAfterIdle();
+        // No ticks are owed for time spent waiting
+        tickAccumulator = 0.0f;
+    }
+    else
+    {
+        PROFILE_ZONE("Frame pacing");
+        auto sleepStart = std::chrono::steady_clock::now();
+        timingSystem->limitFrameRate();
+        timingSystem->recordPhase(FramePhase::SLEEP, secondsSince(sleepStart));
+    }
+
+    frameCount++;
+    if (options.maxFrames > 0 && frameCount >= options.maxFrames)
+    {
+        std::cout << "Reached frame limit (" << frameCount << " frames), exiting" << std::endl;
+        running = false;
+    }
+}
+
+bool Game::presentSnapshot(const RenderSnapshot *snapshot)
+{
+    if (!snapshot)
+        return false;
+
+    // Outside gameplay nothing moves on its own; if the snapshot matches what is
+    // already on screen, leave the last presented frame up instead of redrawing it
+    bool canIdle = !options.headless && snapshot->sceneStatic;
+    if (canIdle && !forceRedraw && snapshot->contentHash == presentedHash)
+        return false;
+
+    PROFILE_ZONE("Render");
+    auto renderStart = std::chrono::steady_clock::now();
+    renderSystem->renderSnapshot(*snapshot);
+    float presentTime = renderSystem->getLastPresentTime();
+    timingSystem->recordPhase(FramePhase::RENDER, secondsSince(renderStart) - presentTime);
+    timingSystem->recordPhase(FramePhase::PRESENT, presentTime);
+    presentedHash = snapshot->contentHash;
+    forceRedraw = false;
+    return true;
+}
+
+void Game::simulateFrame(float deltaTime, float fps, float pacingError, const FrameTimeSummary &frameTimes)
+{
+    PROFILE_ZONE("Simulate frame");
+    auto simulateStart = std::chrono::steady_clock::now();
+
+    // Run whole fixed ticks for the elapsed time; after a long hitch, drop what
+    // the catch-up limit can't cover instead of spiralling
+    tickAccumulator += deltaTime;
+    int steps = 0;
+    while (tickAccumulator >= fixedDeltaTime && steps < maxCatchUpSteps)
+    {
+        simulateTick(fixedDeltaTime);
+        tickAccumulator -= fixedDeltaTime;
+        steps++;
+    }
+    if (tickAccumulator >= fixedDeltaTime)
+    {
+        tickAccumulator = std::fmod(tickAccumulator, fixedDeltaTime);
+    }
+
+    // Update UI (update text content)
+    auto uiStart = std::chrono::steady_clock::now();
+    {
+        PROFILE_ZONE("UI");
+        updateUI(fps, pacingError, frameTimes);
+    }
+    uiSeconds = secondsSince(uiStart);
+
+    // Render the leftover fraction of a tick by interpolating positions
+    {
+        PROFILE_ZONE("Build snapshot");
+        publishSnapshot(tickAccumulator / fixedDeltaTime);
+    }
+    simulateSeconds = secondsSince(simulateStart) - uiSeconds;
+}
+
+void Game::simulateTick(float deltaTime)
+{
+    PROFILE_ZONE("Tick");
+
+    storePreviousTransforms();
+
+    // Handle input
+    {
+        PROFILE_ZONE("InputSystem");
+        inputSystem->update(ecs, gameManager, deltaTime);
+    }
+
+    // Update game logic (only if playing)
     if (gameManager.currentState == GameManager::PLAYING)
     {
-        movementSystem->update(ecs, deltaTime);
-        animationSystem->update(ecs, deltaTime);
-        audioSystem->update(ecs, gameManager, deltaTime);
+        {
+            PROFILE_ZONE("MovementSystem");
+            movementSystem->update(ecs, deltaTime);
+        }
+        {
+            PROFILE_ZONE("AnimationSystem");
+            animationSystem->update(ecs, deltaTime);
+        }
 
         // Update game time and score
         gameManager.updateGameTime(deltaTime);
 
-        mobSpawningSystem->update(ecs, gameManager, deltaTime);
-        collisionSystem->update(ecs, gameManager, deltaTime);
-        boundarySystem->update(ecs, gameManager, deltaTime);
+        {
+            PROFILE_ZONE("MobSpawningSystem");
+            mobSpawningSystem->update(ecs, gameManager, deltaTime);
+        }
+        {
+            PROFILE_ZONE("CollisionSystem");
+            collisionSystem->update(ecs, gameManager, deltaTime);
+        }
+        {
+            PROFILE_ZONE("BoundarySystem");
+            boundarySystem->update(ecs, gameManager, deltaTime);
+        }
+    }
+
+    // Queue music for state changes, including the ones made this tick
+    {
+        PROFILE_ZONE("AudioSystem");
+        audioSystem->update(ecs, gameManager, deltaTime);
+    }
+
+    // Scroll to the player, then stream chunks around the new view
+    updateCamera();
+    {
+        PROFILE_ZONE("ChunkStreamingSystem");
+        chunkStreamingSystem->update(ecs, gameManager, deltaTime);
+    }
+}
+
+void Game::updateCamera()
+{
+    if (auto *target = ecs.getComponent<Transform>(camera.getTarget()))
+    {
+        camera.centerOn(target->x, target->y);
+    }
+}
+
+void Game::storePreviousTransforms()
+{
+    auto &previousTransforms = ecs.getComponents<PreviousTransform>();
+    for (auto &[entityID, previous] : previousTransforms)
+    {
+        if (auto *transform = ecs.getComponent<Transform>(entityID))
+        {
+            previous.x = transform->x;
+            previous.y = transform->y;
+        }
+    }
+}
+
+void Game::publishSnapshot(float alpha)
+{
+    RenderSnapshot &snapshot = snapshots.beginWrite();
+    renderSystem->buildSnapshot(ecs, snapshot, camera, alpha);
+    snapshot.frameNumber = ++simulatedFrames;
+    totalSpritesDrawn += snapshot.spritesDrawn;
+    totalSpritesCulled += snapshot.spritesCulled;
+    snapshot.sceneStatic = gameManager.currentState != GameManager::PLAYING;
+    snapshots.publish();
+}
+
+void Game::simulationLoop()
+{
+    Profiler::setThreadName("Simulation");
+
+    std::unique_lock<std::mutex> lock(simulationMutex);
+    while (true)
+    {
+        simulationCondition.wait(lock, [this]
+                                 { return simulationPending || simulationStopping; });
+        if (!simulationPending)
+            break;
+
+        float deltaTime = simulationDeltaTime;
+        float fps = simulationFPS;
+        float pacingError = simulationPacingError;
+        FrameTimeSummary frameTimes = simulationFrameTimes;
+        lock.unlock();
+        simulateFrame(deltaTime, fps, pacingError, frameTimes);
+        lock.lock();
+
+        simulationPending = false;
+        simulationCondition.notify_all();
+    }
+}
+
+void Game::startSimulation(float deltaTime, float fps, float pacingError, const FrameTimeSummary &frameTimes)
+{
+    {
+        std::lock_guard<std::mutex> lock(simulationMutex);
+        simulationDeltaTime = deltaTime;
+        simulationFPS = fps;
+        simulationPacingError = pacingError;
+        simulationFrameTimes = frameTimes;
+        simulationPending = true;
     }
+    simulationCondition.notify_all();
+}
 
-    // 4. Update UI (update text content)
-    updateUI();
+void Game::waitForSimulation()
+{
+    std::unique_lock<std::mutex> lock(simulationMutex);
+    simulationCondition.wait(lock, [this]
+                             { return !simulationPending; });
+}
 
-    // 5. Render everything
-    renderSystem->update(ecs, gameManager, timingSystem->getFPS());
+void Game::stopSimulationThread()
+{
+    if (!simulationThread.joinable())
+        return;
 
-    // 6. Frame limiting to maintain 60 FPS
-    timingSystem->limitFrameRate();
+    {
+        std::lock_guard<std::mutex> lock(simulationMutex);
+        simulationStopping = true;
+    }
+    simulationCondition.notify_all();
+    simulationThread.join();
 }
 
 void Game::handleEvents()
@@ -261,15 +919,53 @@ void Game::handleEvents()
             running = false;
         }
 
+        // Exposed, resized or restored windows need their contents drawn again
+        if (e.type == SDL_WINDOWEVENT)
+        {
+            forceRedraw = true;
+        }
+
+        // Device loss or a fullscreen toggle can wipe render targets, including composed text
+        if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET)
+        {
+            renderSystem->invalidateRenderTargets(e.type == SDL_RENDER_DEVICE_RESET);
+            forceRedraw = true;
+        }
+
         // Handle escape key for quitting
         if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)
         {
             running = false;
         }
+
+        // F9 starts the profiler, or saves what it has recorded
+        if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F9 && !e.key.repeat)
+        {
+            saveProfile();
+        }
     }
 }
 
-void Game::updateUI()
+void Game::saveProfile()
+{
+    if (!Profiler::isEnabled())
+    {
+        Profiler::setEnabled(true);
+        std::cout << "Profiler recording, press F9 again to save the last " << options.profileSeconds << " s"
+                  << std::endl;
+        return;
+    }
+
+    // Events are handled between frames, so the simulation thread is parked
+    char path[32];
+    std::snprintf(path, sizeof(path), "profile_%06d.json", frameCount);
+    if (Profiler::writeTrace(path, options.profileSeconds))
+        std::cout << "Profile written to " << path << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+    else
+        std::cerr << "Failed to write profile: " << path << std::endl;
+}
+
+void Game::updateUI(float fps, float pacingError, const FrameTimeSummary &frameTimes)
 {
     // Update score display
     auto &uiTextComponents = ecs.getComponents<UIText>();
@@ -279,15 +975,32 @@ void Game::updateUI()
         if (!entityType)
             continue;
 
-        if (entityType->type == "scoreDisplay")
+        if (entityType->id == scoreDisplayType)
         {
             uiText.content = "Score: " + std::to_string(gameManager.score);
         }
-        else if (entityType->type == "fpsDisplay")
+        else if (entityType->id == fpsDisplayType)
+        {
+            uiText.content = "FPS: " + std::to_string(static_cast<int>(fps));
+            if (timingSystem->getPacingMode() != PacingMode::UNLOCKED)
+            {
+                // Worst deviation from the target frame interval over the last second
+                char pacing[32];
+                std::snprintf(pacing, sizeof(pacing), " (pacing %.2f ms)", pacingError);
+                uiText.content += pacing;
+            }
+        }
+        else if (entityType->id == frameTimeDisplayType)
         {
-            uiText.content = "FPS: " + std::to_string(static_cast<int>(timingSystem->getFPS()));
+            // Frame-time percentiles over the last few seconds and frames whose work overran the budget
+            uiText.visible = frameTimes.count > 0;
+            char text[96];
+            std::snprintf(text, sizeof(text), "p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f ms, %llu over",
+                          frameTimes.p50, frameTimes.p90, frameTimes.p99, frameTimes.p999, frameTimes.max,
+                          static_cast<unsigned long long>(frameTimes.overBudget));
+            uiText.content = text;
         }
-        else if (entityType->type == "gameMessage")
+        else if (entityType->id == gameMessageType)
         {
             switch (gameManager.currentState)
             {
@@ -1,28 +1,59 @@
 #pragma once
 #include "ECS.h"
+#include "Camera.h"
 #include "../managers/GameManager.h"
 #include "../systems/Systems.h"
 #include "../managers/EntityFactory.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 class ResourceManager; // Forward declaration
 
+// Launch options parsed from the command line
+struct GameOptions
+{
+    bool headless = false;         // No window; render with the CPU backend into an offscreen buffer
+    std::string dumpFramesDir;     // Write every rendered frame here (CPU backend only)
+    int maxFrames = 0;             // Quit after this many frames (0 = run until closed)
+    bool autoStart = false;        // Skip the menu and start playing immediately
+    int renderThreads = 0;         // CPU backend compositing threads (0 = one per hardware thread)
+    bool pipelined = true;         // Simulate frame N+1 on a worker thread while frame N renders
+    int tickRate = 0;              // Fixed simulation ticks per second (0 = gameSettings.tickRate)
+    PacingMode pacing = PacingMode::FIXED; // Frame pacing (headless runs are always unlocked)
+    float targetFPS = 60.0f;       // Frame rate for FIXED pacing
+    int loaderThreads = 0;         // Image decode workers (0 = one per hardware thread)
+    std::string bundlePath;        // Load assets from this pre-decoded bundle (empty = loose files)
+    AudioOutput audio = AudioOutput::AUTO; // Sound device, null device or offline mixer
+    std::string dumpAudioPath;     // Write the offline mix here as WAV
+    std::string profilePath;       // Profile from the start and write a Chrome trace here at exit
+    float profileSeconds = 10.0f;  // How much recent history a trace covers
+};
+
 class Game
 {
 private:
     // Core systems
     ECS ecs;
     GameManager gameManager;
+    GameOptions options;
+    Camera camera;
 
     // SDL components
     SDL_Window *window;
     SDL_Renderer *renderer;
+    SDL_Surface *offscreenSurface; // Backing surface of the software renderer in headless mode
     bool running;
+    int frameCount;
+    float uploadBudgetMs; // Render-thread time per frame for creating streamed-in textures
 
-    // Resource management
+    // Resource management (the bundle is declared first so it outlives everything loaded from it)
+    std::unique_ptr<AssetBundle> assetBundle;
     std::unique_ptr<ResourceManager> resourceManager;
     std::unique_ptr<EntityFactory> entityFactory;
 
@@ -35,15 +66,58 @@ private:
     std::unique_ptr<MobSpawningSystem> mobSpawningSystem;
     std::unique_ptr<CollisionSystem> collisionSystem;
     std::unique_ptr<BoundarySystem> boundarySystem;
+    std::unique_ptr<ChunkStreamingSystem> chunkStreamingSystem;
     std::unique_ptr<RenderSystem> renderSystem;
 
+    // Fixed-timestep simulation: frame time accumulates and is consumed in whole ticks
+    float fixedDeltaTime;
+    int maxCatchUpSteps;
+    float tickAccumulator;
+
+    // Simulation/render pipeline: the simulation thread publishes snapshots,
+    // the main thread (which owns the renderer) draws the latest one
+    SnapshotRing snapshots;
+    Uint64 simulatedFrames;
+    Uint64 totalSpritesDrawn;
+    Uint64 totalSpritesCulled;
+    std::thread simulationThread;
+
+    // Opens sound effects and probes music while the sprite atlas decodes; SDL_mixer
+    // belongs to it until loadAudioAssets() joins it
+    std::thread audioLoader;
+    std::mutex simulationMutex;
+    std::condition_variable simulationCondition;
+    bool simulationPending;
+    bool simulationStopping;
+    float simulationDeltaTime;
+    float simulationFPS;
+    float simulationPacingError;
+    FrameTimeSummary simulationFrameTimes;
+
+    // Phase times of the last simulateFrame(), written by whichever thread ran it
+    float simulateSeconds;
+    float uiSeconds;
+
+    // Idle-aware rendering: in menus, frames identical to the one on screen are skipped
+    // and the loop sleeps until an event arrives
+    static constexpr int IDLE_WAIT_MS = 100;
+    Uint64 presentedHash;
+    bool idle;
+    bool forceRedraw;
+
     // TODO: Systems to be implemented in Phase 4
     // std::unique_ptr<HudSystem> hudSystem;
     // std::unique_ptr<CleanupSystem> cleanupSystem;    // Entity IDs
     EntityID playerEntityID;
 
+    // UI element types updated every frame, resolved once from the type registry
+    EntityTypeId scoreDisplayType;
+    EntityTypeId fpsDisplayType;
+    EntityTypeId frameTimeDisplayType;
+    EntityTypeId gameMessageType;
+
 public:
-    Game();
+    Game(const GameOptions &options = GameOptions());
     ~Game();
 
     bool initialize();
@@ -52,10 +126,26 @@ public:
 
 private:
     bool initializeSDL();
+    bool createRenderer();
+    void initializePacing();
+    std::unique_ptr<AudioBackend> createAudioBackend() const;
     bool loadAssets();
+    void startAudioLoad();
+    void loadAudioFiles(json audio);
     bool loadAudioAssets();
     void createInitialEntities();
     void gameLoop();
     void handleEvents();
-    void updateUI();
+    void saveProfile();
+    void updateUI(float fps, float pacingError, const FrameTimeSummary &frameTimes);
+    void simulateFrame(float deltaTime, float fps, float pacingError, const FrameTimeSummary &frameTimes);
+    void simulateTick(float deltaTime);
+    void storePreviousTransforms();
+    void updateCamera();
+    void publishSnapshot(float alpha);
+    void simulationLoop();
+    void startSimulation(float deltaTime, float fps, float pacingError, const FrameTimeSummary &frameTimes);
+    void waitForSimulation();
+    bool presentSnapshot(const RenderSnapshot *snapshot);
+    void stopSimulationThread();
 };
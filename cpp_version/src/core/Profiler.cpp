@@ -0,0 +1,164 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Profiler::enabled(false);
+
+namespace
+{
+    struct ZoneEvent
+    {
+        const char *name;
+        Uint64 start;
+        Uint64 end;
+    };
+
+    // Relaxed atomics compile to plain moves; they only make it legal for the
+    // trace writer to read a slot the owner is overwriting (that copy is discarded)
+    struct EventSlot
+    {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<Uint64> start{0};
+        std::atomic<Uint64> end{0};
+    };
+
+    // Written only by its thread; `written` is published after each event so a
+    // reader knows which slots hold finished events
+    struct ThreadRing
+    {
+        const char *name = nullptr;
+        int id = 0;
+        std::unique_ptr<EventSlot[]> events;
+        std::atomic<Uint64> written{0}; // Events ever recorded; slot = index % RING_EVENTS
+    };
+
+    // Rings outlive their threads so a trace can still show threads that have exited
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    thread_local ThreadRing *currentRing = nullptr;
+    thread_local const char *currentThreadName = nullptr;
+
+    ThreadRing *registerThread()
+    {
+        auto ring = std::make_unique<ThreadRing>();
+        ring->events = std::make_unique<EventSlot[]>(Profiler::RING_EVENTS);
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ring->id = static_cast<int>(rings.size()) + 1;
+        ring->name = currentThreadName;
+        rings.push_back(std::move(ring));
+        return rings.back().get();
+    }
+}
+
+void Profiler::setThreadName(const char *name)
+{
+    currentThreadName = name;
+    if (currentRing)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        currentRing->name = name;
+    }
+}
+
+Uint64 Profiler::now()
+{
+    return static_cast<Uint64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+void Profiler::record(const char *name, Uint64 start, Uint64 end)
+{
+    // The first zone on a thread allocates its ring
+    if (!currentRing)
+        currentRing = registerThread();
+
+    Uint64 index = currentRing->written.load(std::memory_order_relaxed);
+    EventSlot &slot = currentRing->events[index % RING_EVENTS];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    currentRing->written.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::writeTrace(const std::string &path, float seconds)
+{
+    struct ThreadEvents
+    {
+        int id;
+        const char *name;
+        std::vector<ZoneEvent> events;
+    };
+    std::vector<ThreadEvents> threads;
+
+    Uint64 cutoff = now() - static_cast<Uint64>(std::max(seconds, 0.0f) * 1e9);
+    Uint64 origin = ~0ULL;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto &ring : rings)
+        {
+            ThreadEvents thread{ring->id, ring->name, {}};
+
+            Uint64 last = ring->written.load(std::memory_order_acquire);
+            Uint64 first = last > RING_EVENTS ? last - RING_EVENTS : 0;
+            thread.events.reserve(static_cast<size_t>(last - first));
+            for (Uint64 i = first; i < last; ++i)
+            {
+                const EventSlot &slot = ring->events[i % RING_EVENTS];
+                thread.events.push_back({slot.name.load(std::memory_order_relaxed),
+                                         slot.start.load(std::memory_order_relaxed),
+                                         slot.end.load(std::memory_order_relaxed)});
+            }
+
+            // The owner kept recording while we copied: drop the slots it may have
+            // reused since, including the one it could be writing right now
+            Uint64 written = ring->written.load(std::memory_order_acquire);
+            Uint64 firstIntact = written + 1 > RING_EVENTS ? written + 1 - RING_EVENTS : 0;
+            if (firstIntact > first)
+            {
+                size_t torn = static_cast<size_t>(std::min(firstIntact - first, last - first));
+                thread.events.erase(thread.events.begin(), thread.events.begin() + torn);
+            }
+
+            thread.events.erase(std::remove_if(thread.events.begin(), thread.events.end(),
+                                               [cutoff](const ZoneEvent &event) { return event.end < cutoff; }),
+                                thread.events.end());
+            for (const ZoneEvent &event : thread.events)
+                origin = std::min(origin, event.start);
+
+            threads.push_back(std::move(thread));
+        }
+    }
+
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    // Complete ("X") events in microseconds; nesting is recovered from the time ranges
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"DodgeTheCreeps\"}}");
+    for (const ThreadEvents &thread : threads)
+    {
+        if (thread.name)
+        {
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                         thread.id, thread.name);
+            std::fprintf(file, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+                         thread.id, thread.id);
+        }
+        for (const ZoneEvent &event : thread.events)
+        {
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         event.name, thread.id, (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0);
+        }
+    }
+    std::fprintf(file, "\n]}\n");
+
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,80 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : cellSize(std::max(cellSize, 1.0f)), maxHalfWidth(0.0f), maxHalfHeight(0.0f), entryCount(0) {}
+
+int SpatialGrid::toCell(float coordinate) const
+{
+    return static_cast<int>(std::floor(coordinate / cellSize));
+}
+
+Uint64 SpatialGrid::cellKey(int cellX, int cellY)
+{
+    return (static_cast<Uint64>(static_cast<Uint32>(cellX)) << 32) | static_cast<Uint32>(cellY);
+}
+
+void SpatialGrid::clear()
+{
+    // Cells that stayed empty for a whole build are dropped so memory follows
+    // the occupied area, not everywhere entities have ever been
+    for (auto it = cells.begin(); it != cells.end();)
+    {
+        if (it->second.empty())
+        {
+            it = cells.erase(it);
+        }
+        else
+        {
+            it->second.clear();
+            ++it;
+        }
+    }
+    maxHalfWidth = maxHalfHeight = 0.0f;
+    entryCount = 0;
+}
+
+void SpatialGrid::insert(EntityID entityID, float centerX, float centerY, float halfWidth, float halfHeight)
+{
+    Entry entry = {entityID, centerX - halfWidth, centerY - halfHeight, centerX + halfWidth, centerY + halfHeight};
+    cells[cellKey(toCell(centerX), toCell(centerY))].push_back(entry);
+
+    maxHalfWidth = std::max(maxHalfWidth, halfWidth);
+    maxHalfHeight = std::max(maxHalfHeight, halfHeight);
+    entryCount++;
+}
+
+void SpatialGrid::query(const SDL_FRect &rect, std::vector<EntityID> &results) const
+{
+    if (entryCount == 0)
+        return;
+
+    // Any entity overlapping rect has its center within rect grown by the largest half-extent
+    int firstX = toCell(rect.x - maxHalfWidth);
+    int lastX = toCell(rect.x + rect.w + maxHalfWidth);
+    int firstY = toCell(rect.y - maxHalfHeight);
+    int lastY = toCell(rect.y + rect.h + maxHalfHeight);
+
+    float rectMaxX = rect.x + rect.w;
+    float rectMaxY = rect.y + rect.h;
+
+    for (int cellY = firstY; cellY <= lastY; ++cellY)
+    {
+        for (int cellX = firstX; cellX <= lastX; ++cellX)
+        {
+            auto it = cells.find(cellKey(cellX, cellY));
+            if (it == cells.end())
+                continue;
+
+            for (const Entry &entry : it->second)
+            {
+                if (entry.maxX > rect.x && entry.minX < rectMaxX &&
+                    entry.maxY > rect.y && entry.minY < rectMaxY)
+                {
+                    results.push_back(entry.entityID);
+                }
+            }
+        }
+    }
+}
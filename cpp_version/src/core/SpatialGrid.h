@@ -0,0 +1,41 @@
+#pragma once
+#include "ECS.h"
+#include <SDL2/SDL.h>
+#include <unordered_map>
+#include <vector>
+
+// Uniform hash grid over axis-aligned entity bounds. Each entity is stored in
+// the cell holding its center; queries widen the search by the largest
+// half-extent inserted so far and then test bounds exactly, so no entity is
+// reported twice. Cell storage is kept between rebuilds to avoid allocation.
+class SpatialGrid
+{
+private:
+    struct Entry
+    {
+        EntityID entityID;
+        float minX, minY, maxX, maxY;
+    };
+
+    float cellSize;
+    float maxHalfWidth, maxHalfHeight;
+    size_t entryCount;
+    std::unordered_map<Uint64, std::vector<Entry>> cells;
+
+    int toCell(float coordinate) const;
+    static Uint64 cellKey(int cellX, int cellY);
+
+public:
+    explicit SpatialGrid(float cellSize = 128.0f);
+
+    // Empty every cell (capacity is kept)
+    void clear();
+
+    void insert(EntityID entityID, float centerX, float centerY, float halfWidth, float halfHeight);
+
+    // Append the entities whose bounds overlap rect
+    void query(const SDL_FRect &rect, std::vector<EntityID> &results) const;
+
+    size_t size() const { return entryCount; }
+    float getCellSize() const { return cellSize; }
+};
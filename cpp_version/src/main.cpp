@@ -1,9 +1,104 @@
 #include "core/Game.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --headless          Render with the CPU backend into an offscreen buffer (no window)\n"
+              << "  --dump-frames DIR   Write every rendered frame to DIR as PPM (with --headless)\n"
+              << "  --frames N          Quit after N frames\n"
+              << "  --autostart         Start playing immediately instead of showing the menu\n"
+              << "  --render-threads N  CPU backend compositing threads (0 = all cores, default)\n"
+              << "  --no-pipeline       Simulate and render sequentially on the main thread\n"
+              << "  --tick-rate HZ      Fixed simulation ticks per second (default: entities.json)\n"
+              << "  --pacing MODE       Frame pacing: vsync, fixed (default) or unlocked\n"
+              << "  --fps N             Target frame rate for fixed pacing (default 60)\n"
+              << "  --loader-threads N  Image decode threads (0 = all cores, default)\n"
+              << "  --bundle FILE       Load assets from a bundle made by asset_bundler\n"
+              << "  --audio MODE        Audio output: device, null or offline (default: offline with --headless)\n"
+              << "  --dump-audio FILE   Write the offline audio mix to FILE as WAV\n"
+              << "  --profile FILE      Record profiling zones and write the last seconds as a Chrome trace at exit\n"
+              << "  --profile-seconds N Trace length for --profile and F9 (default 10)\n";
+}
+
 int main(int argc, char *argv[])
 {
-    Game game;
+    GameOptions options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            options.headless = true;
+        }
+        else if (std::strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc)
+        {
+            options.dumpFramesDir = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            options.maxFrames = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--autostart") == 0)
+        {
+            options.autoStart = true;
+        }
+        else if (std::strcmp(argv[i], "--render-threads") == 0 && i + 1 < argc)
+        {
+            options.renderThreads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--no-pipeline") == 0)
+        {
+            options.pipelined = false;
+        }
+        else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            options.tickRate = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--pacing") == 0 && i + 1 < argc &&
+                 TimingSystem::parsePacingMode(argv[i + 1], options.pacing))
+        {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            options.targetFPS = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--loader-threads") == 0 && i + 1 < argc)
+        {
+            options.loaderThreads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--bundle") == 0 && i + 1 < argc)
+        {
+            options.bundlePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--audio") == 0 && i + 1 < argc &&
+                 AudioSystem::parseAudioOutput(argv[i + 1], options.audio))
+        {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--dump-audio") == 0 && i + 1 < argc)
+        {
+            options.dumpAudioPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            options.profilePath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--profile-seconds") == 0 && i + 1 < argc)
+        {
+            options.profileSeconds = static_cast<float>(std::atof(argv[++i]));
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    Game game(options);
 
     if (!game.initialize())
     {
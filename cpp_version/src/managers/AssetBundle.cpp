@@ -0,0 +1,292 @@
+#include "AssetBundle.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetBundle::~AssetBundle()
+{
+    close();
+}
+
+bool AssetBundle::open(const std::string &path)
+{
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Failed to open asset bundle: " << path << " - " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        std::cerr << "Failed to read asset bundle size: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    mappedSize = static_cast<size_t>(info.st_size);
+    void *address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (address == MAP_FAILED)
+    {
+        std::cerr << "Failed to map asset bundle: " << path << " - " << std::strerror(errno) << std::endl;
+        mappedSize = 0;
+        return false;
+    }
+
+    // Ask for the whole file up front: the kernel reads it ahead in one sequential
+    // pass instead of faulting pages in as each asset is touched
+    madvise(address, mappedSize, MADV_WILLNEED);
+    mapped = static_cast<const Uint8 *>(address);
+#else
+    // No mmap: a single sequential read into memory gives the same access pattern
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cerr << "Failed to open asset bundle: " << path << std::endl;
+        return false;
+    }
+    fileContents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (fileContents.empty() || !file.read(reinterpret_cast<char *>(fileContents.data()), fileContents.size()))
+    {
+        std::cerr << "Failed to read asset bundle: " << path << std::endl;
+        fileContents.clear();
+        return false;
+    }
+    mapped = fileContents.data();
+    mappedSize = fileContents.size();
+#endif
+
+    if (!parseIndex(path))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AssetBundle::parseIndex(const std::string &path)
+{
+    FileHeader header;
+    if (mappedSize < sizeof(header))
+    {
+        std::cerr << "Asset bundle is truncated: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, mapped, sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+        std::cerr << "Not a version " << VERSION << " asset bundle: " << path
+                  << " (rebuild it with asset_bundler)" << std::endl;
+        return false;
+    }
+    if (header.indexOffset > mappedSize || header.indexSize > mappedSize - header.indexOffset)
+    {
+        std::cerr << "Asset bundle index is out of range: " << path << std::endl;
+        return false;
+    }
+
+    // Records are unaligned in the index, so copy each one out before reading it
+    const Uint8 *cursor = mapped + header.indexOffset;
+    const Uint8 *indexEnd = cursor + header.indexSize;
+    for (Uint32 i = 0; i < header.entryCount; ++i)
+    {
+        FileEntry record;
+        if (static_cast<size_t>(indexEnd - cursor) < sizeof(record))
+            break;
+        std::memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+
+        if (static_cast<size_t>(indexEnd - cursor) < record.nameLength ||
+            record.offset > mappedSize || record.size > mappedSize - record.offset)
+        {
+            std::cerr << "Asset bundle entry " << i << " is corrupt: " << path << std::endl;
+            return false;
+        }
+        std::string name(reinterpret_cast<const char *>(cursor), record.nameLength);
+        cursor += record.nameLength;
+
+        Entry entry;
+        entry.type = static_cast<EntryType>(record.type);
+        entry.data = mapped + record.offset;
+        entry.size = record.size;
+        if (entry.type == TEXTURE)
+        {
+            entry.width = static_cast<int>(record.params[0]);
+            entry.height = static_cast<int>(record.params[1]);
+            if (static_cast<Uint64>(entry.width) * entry.height * 4 != entry.size)
+            {
+                std::cerr << "Asset bundle texture has the wrong size: " << name << std::endl;
+                return false;
+            }
+        }
+        else if (entry.type == PCM)
+        {
+            entry.frequency = static_cast<int>(record.params[0]);
+            entry.format = static_cast<Uint16>(record.params[1]);
+            entry.channels = static_cast<int>(record.params[2]);
+        }
+        entries[name] = entry;
+    }
+
+    if (entries.size() != header.entryCount)
+    {
+        std::cerr << "Asset bundle index is truncated: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AssetBundle::close()
+{
+    entries.clear();
+#ifndef _WIN32
+    if (mapped)
+        munmap(const_cast<Uint8 *>(mapped), mappedSize);
+#endif
+    fileContents.clear();
+    fileContents.shrink_to_fit();
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+const AssetBundle::Entry *AssetBundle::find(const std::string &name) const
+{
+    auto it = entries.find(name);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+const AssetBundle::Entry *AssetBundle::find(const std::string &name, EntryType type) const
+{
+    const Entry *entry = find(name);
+    return entry && entry->type == type ? entry : nullptr;
+}
+
+SDL_Surface *AssetBundle::createSurface(const Entry &entry)
+{
+    // SDL only writes to surface pixels on request; the mapping is read-only
+    return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<Uint8 *>(entry.data), entry.width, entry.height,
+                                              32, entry.width * 4, SDL_PIXELFORMAT_RGBA32);
+}
+
+SDL_RWops *AssetBundle::openStream(const Entry &entry)
+{
+    return SDL_RWFromConstMem(entry.data, static_cast<int>(entry.size));
+}
+
+bool AssetBundleWriter::addTexture(const std::string &name, SDL_Surface *rgba)
+{
+    if (!rgba || rgba->format->format != SDL_PIXELFORMAT_RGBA32)
+        return false;
+
+    PendingEntry entry;
+    entry.name = name;
+    entry.type = AssetBundle::TEXTURE;
+    entry.params[0] = static_cast<Uint32>(rgba->w);
+    entry.params[1] = static_cast<Uint32>(rgba->h);
+
+    size_t rowBytes = static_cast<size_t>(rgba->w) * 4;
+    entry.bytes.resize(rowBytes * rgba->h);
+    SDL_LockSurface(rgba);
+    const Uint8 *row = static_cast<const Uint8 *>(rgba->pixels);
+    for (int y = 0; y < rgba->h; ++y)
+    {
+        std::memcpy(entry.bytes.data() + rowBytes * y, row + static_cast<size_t>(rgba->pitch) * y, rowBytes);
+    }
+    SDL_UnlockSurface(rgba);
+
+    pending.push_back(std::move(entry));
+    return true;
+}
+
+void AssetBundleWriter::addPCM(const std::string &name, const Uint8 *samples, Uint32 size,
+                               int frequency, Uint16 format, int channels)
+{
+    PendingEntry entry;
+    entry.name = name;
+    entry.type = AssetBundle::PCM;
+    entry.bytes.assign(samples, samples + size);
+    entry.params[0] = static_cast<Uint32>(frequency);
+    entry.params[1] = format;
+    entry.params[2] = static_cast<Uint32>(channels);
+    pending.push_back(std::move(entry));
+}
+
+void AssetBundleWriter::addBlob(const std::string &name, std::vector<Uint8> bytes)
+{
+    PendingEntry entry;
+    entry.name = name;
+    entry.type = AssetBundle::BLOB;
+    entry.bytes = std::move(bytes);
+    pending.push_back(std::move(entry));
+}
+
+bool AssetBundleWriter::write(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Failed to create asset bundle: " << path << std::endl;
+        return false;
+    }
+
+    // Data section: every entry starts on an aligned offset so mapped pixels and
+    // samples can be handed to SDL without copying
+    static const char padding[AssetBundle::DATA_ALIGNMENT] = {};
+    Uint64 offset = sizeof(AssetBundle::FileHeader);
+    file.seekp(static_cast<std::streamoff>(offset));
+
+    std::vector<Uint8> index;
+    for (const auto &entry : pending)
+    {
+        Uint64 aligned = (offset + AssetBundle::DATA_ALIGNMENT - 1) & ~(AssetBundle::DATA_ALIGNMENT - 1);
+        file.write(padding, static_cast<std::streamsize>(aligned - offset));
+        file.write(reinterpret_cast<const char *>(entry.bytes.data()), static_cast<std::streamsize>(entry.bytes.size()));
+        offset = aligned + entry.bytes.size();
+
+        AssetBundle::FileEntry record;
+        record.type = entry.type;
+        record.nameLength = static_cast<Uint32>(entry.name.size());
+        record.offset = aligned;
+        record.size = entry.bytes.size();
+        std::memcpy(record.params, entry.params, sizeof(record.params));
+
+        const Uint8 *recordBytes = reinterpret_cast<const Uint8 *>(&record);
+        index.insert(index.end(), recordBytes, recordBytes + sizeof(record));
+        index.insert(index.end(), entry.name.begin(), entry.name.end());
+    }
+
+    // Index last, then the header that points at it
+    file.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(index.size()));
+
+    AssetBundle::FileHeader header;
+    std::memcpy(header.magic, AssetBundle::MAGIC, sizeof(header.magic));
+    header.version = AssetBundle::VERSION;
+    header.entryCount = static_cast<Uint32>(pending.size());
+    header.reserved = 0;
+    header.indexOffset = offset;
+    header.indexSize = index.size();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!file)
+    {
+        std::cerr << "Failed to write asset bundle: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
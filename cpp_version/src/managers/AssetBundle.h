@@ -0,0 +1,115 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Single-file pack of pre-decoded assets written by tools/asset_bundler.cpp.
+// The file is memory-mapped, so a cold start is one sequential read and
+// textures, sound chunks and fonts are created straight from the mapped bytes.
+//
+// Layout: Header | entry data (each 16-byte aligned) | index (one record + name per entry)
+class AssetBundle
+{
+public:
+    enum EntryType : Uint32
+    {
+        TEXTURE = 1, // RGBA32 pixels, tightly packed rows (pitch = width * 4)
+        PCM = 2,     // Audio already converted to the mixer's output format
+        BLOB = 3     // File bytes as-is (fonts, streamed music)
+    };
+
+    struct Entry
+    {
+        EntryType type;
+        const Uint8 *data; // Points into the mapping; valid while the bundle is open
+        Uint64 size;
+
+        // TEXTURE
+        int width = 0;
+        int height = 0;
+
+        // PCM
+        int frequency = 0;
+        Uint16 format = 0;
+        int channels = 0;
+    };
+
+    static constexpr char MAGIC[4] = {'D', 'T', 'C', 'B'};
+    static constexpr Uint32 VERSION = 1;
+    static constexpr Uint64 DATA_ALIGNMENT = 16;
+
+    // On-disk records (native byte order; bundles are built on the target platform)
+    struct FileHeader
+    {
+        char magic[4];
+        Uint32 version;
+        Uint32 entryCount;
+        Uint32 reserved;
+        Uint64 indexOffset;
+        Uint64 indexSize;
+    };
+    struct FileEntry
+    {
+        Uint32 type;
+        Uint32 nameLength; // Name bytes follow the record
+        Uint64 offset;
+        Uint64 size;
+        Uint32 params[4];  // TEXTURE: width, height; PCM: frequency, format, channels
+    };
+
+private:
+    const Uint8 *mapped = nullptr;
+    size_t mappedSize = 0;
+    std::vector<Uint8> fileContents; // Used instead of a mapping where mmap is unavailable
+    std::unordered_map<std::string, Entry> entries;
+
+    bool parseIndex(const std::string &path);
+
+public:
+    AssetBundle() = default;
+    ~AssetBundle();
+    AssetBundle(const AssetBundle &) = delete;
+    AssetBundle &operator=(const AssetBundle &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return mapped != nullptr; }
+
+    // Look up an asset by its path relative to ASSET_PATH (e.g. "art/gameover.wav")
+    const Entry *find(const std::string &name) const;
+    const Entry *find(const std::string &name, EntryType type) const;
+    size_t getEntryCount() const { return entries.size(); }
+    size_t getSize() const { return mappedSize; }
+
+    // Surface that borrows a TEXTURE entry's mapped pixels (free with SDL_FreeSurface;
+    // the pixels stay in the bundle). The surface must only be read from.
+    static SDL_Surface *createSurface(const Entry &entry);
+
+    // Read-only stream over an entry's bytes, for the SDL_*_RW loaders
+    static SDL_RWops *openStream(const Entry &entry);
+};
+
+// Collects assets in memory and writes them out as a bundle (used by the bundler tool)
+class AssetBundleWriter
+{
+private:
+    struct PendingEntry
+    {
+        std::string name;
+        AssetBundle::EntryType type;
+        std::vector<Uint8> bytes;
+        Uint32 params[4] = {0, 0, 0, 0};
+    };
+    std::vector<PendingEntry> pending;
+
+public:
+    // Copies an RGBA32 surface, dropping the row pitch
+    bool addTexture(const std::string &name, SDL_Surface *rgba);
+    void addPCM(const std::string &name, const Uint8 *samples, Uint32 size,
+                int frequency, Uint16 format, int channels);
+    void addBlob(const std::string &name, std::vector<Uint8> bytes);
+
+    size_t getEntryCount() const { return pending.size(); }
+    bool write(const std::string &path) const;
+};
@@ -0,0 +1,166 @@
+#include "AssetLoader.h"
+#include "../core/Profiler.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <iostream>
+
+AssetLoader::AssetLoader(int threadCount)
+{
+    int count = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    count = std::max(count, 1);
+    for (int i = 0; i < count; ++i)
+    {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+AssetLoader::~AssetLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    // Nobody will pick these up any more
+    for (auto &result : results)
+    {
+        if (result.surface)
+            SDL_FreeSurface(result.surface);
+    }
+}
+
+SDL_Surface *AssetLoader::decodeImage(const std::string &path)
+{
+    std::string fullPath = std::string(ASSET_PATH) + path;
+    SDL_Surface *loaded = IMG_Load(fullPath.c_str());
+    if (!loaded)
+    {
+        std::cerr << "Failed to decode image: " << fullPath << " - " << IMG_GetError() << std::endl;
+        return nullptr;
+    }
+
+    SDL_Surface *rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!rgba)
+    {
+        std::cerr << "Failed to convert image: " << path << " - " << SDL_GetError() << std::endl;
+    }
+    return rgba;
+}
+
+bool AssetLoader::readFile(const std::string &path, std::vector<Uint8> &data)
+{
+    std::string fullPath = std::string(ASSET_PATH) + path;
+    SDL_RWops *file = SDL_RWFromFile(fullPath.c_str(), "rb");
+    if (!file)
+    {
+        std::cerr << "Failed to open file: " << fullPath << " - " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    Sint64 size = SDL_RWsize(file);
+    data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    bool complete = size >= 0 && SDL_RWread(file, data.data(), 1, data.size()) == data.size();
+    SDL_RWclose(file);
+    if (!complete)
+    {
+        std::cerr << "Failed to read file: " << fullPath << " - " << SDL_GetError() << std::endl;
+        data.clear();
+    }
+    return complete;
+}
+
+void AssetLoader::workerLoop()
+{
+    Profiler::setThreadName("Asset loader");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        jobReady.wait(lock, [this]
+                      { return stopping || !jobs.empty(); });
+        if (stopping)
+            break;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        SDL_Surface *surface;
+        {
+            PROFILE_ZONE("Decode image");
+            surface = decodeImage(job.path);
+        }
+
+        lock.lock();
+        results.push_back({job.ticket, std::move(job.path), surface});
+        completedJobs++;
+        jobDone.notify_all();
+    }
+}
+
+int AssetLoader::enqueue(const std::string &path)
+{
+    int ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ticket = nextTicket++;
+        jobs.push_back({ticket, path});
+    }
+    jobReady.notify_one();
+    return ticket;
+}
+
+bool AssetLoader::pollDecoded(DecodedImage &image)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty())
+        return false;
+
+    image = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+std::vector<SDL_Surface *> AssetLoader::decodeAll(const std::vector<std::string> &paths)
+{
+    std::vector<SDL_Surface *> surfaces(paths.size(), nullptr);
+    std::vector<int> tickets;
+    for (const auto &path : paths)
+    {
+        tickets.push_back(enqueue(path));
+    }
+
+    // Collect our tickets as they finish; results of other requests stay queued
+    size_t remaining = tickets.size();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        for (auto it = results.begin(); it != results.end();)
+        {
+            auto match = std::find(tickets.begin(), tickets.end(), it->ticket);
+            if (match == tickets.end())
+            {
+                ++it;
+                continue;
+            }
+            surfaces[match - tickets.begin()] = it->surface;
+            it = results.erase(it);
+            remaining--;
+        }
+
+        if (remaining == 0 || stopping)
+            break;
+
+        Uint64 seen = completedJobs;
+        jobDone.wait(lock, [&]
+                     { return completedJobs != seen || stopping; });
+    }
+    return surfaces;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Worker pool that decodes image files into RGBA32 surfaces off the render
+// thread. Decoding (file IO, PNG inflate, format conversion) is the slow part
+// of loading a texture; creating the GPU texture from the surface is left to
+// the caller on the thread that owns the renderer.
+class AssetLoader
+{
+public:
+    struct DecodedImage
+    {
+        int ticket;
+        std::string path;     // As requested (relative to ASSET_PATH)
+        SDL_Surface *surface; // RGBA32, owned by the receiver; nullptr if decoding failed
+    };
+
+private:
+    struct Job
+    {
+        int ticket;
+        std::string path;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::deque<Job> jobs;
+    std::deque<DecodedImage> results;
+    int nextTicket = 0;
+    Uint64 completedJobs = 0; // Bumped per finished job so waiters can tell new results from old
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    // threadCount: 0 = one per hardware thread (at least one worker is always started)
+    explicit AssetLoader(int threadCount = 0);
+    ~AssetLoader();
+
+    // Queue an image for decoding; returns a ticket that identifies the result
+    int enqueue(const std::string &path);
+
+    // Take one finished image, if any (non-blocking)
+    bool pollDecoded(DecodedImage &image);
+
+    // Decode a batch in parallel and block until all are done; surfaces are
+    // returned in the order of paths (nullptr where decoding failed)
+    std::vector<SDL_Surface *> decodeAll(const std::vector<std::string> &paths);
+
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+
+    static SDL_Surface *decodeImage(const std::string &path);
+
+    // Read a whole file (relative to ASSET_PATH) for loaders that parse from
+    // memory through SDL_RWFromConstMem; safe on any thread
+    static bool readFile(const std::string &path, std::vector<Uint8> &data);
+};
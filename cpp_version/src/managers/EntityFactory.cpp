@@ -17,13 +17,24 @@ bool EntityFactory::loadConfig(const std::string &configFile)
     try
     {
         file >> entityConfig;
-        return true;
     }
     catch (const json::exception &e)
     {
         std::cerr << "Failed to parse JSON config: " << e.what() << std::endl;
         return false;
     }
+
+    // Intern every type name once; entities carry the resulting IDs
+    if (entityConfig.contains("player"))
+        typeRegistry.intern("player");
+    for (const char *section : {"mobs", "ui"})
+    {
+        if (!entityConfig.contains(section))
+            continue;
+        for (const auto &[name, config] : entityConfig[section].items())
+            typeRegistry.intern(name);
+    }
+    return true;
 }
 
 EntityID EntityFactory::createPlayer(ECS &ecs)
@@ -40,6 +51,7 @@ EntityID EntityFactory::createPlayer(ECS &ecs)
     // Add Transform component with start position
     Transform transform = createTransformFromJSON(playerConfig, playerConfig["startPosition"]);
     ecs.addComponent(playerID, transform);
+    ecs.addComponent(playerID, PreviousTransform(transform.x, transform.y));
 
     // Add Velocity component (starts at zero)
     ecs.addComponent(playerID, Velocity(0, 0));
@@ -49,6 +61,7 @@ EntityID EntityFactory::createPlayer(ECS &ecs)
 
     // Add Sprite component (start with horizontal sprite)
     Sprite sprite = createSpriteFromJSON(playerConfig["sprites"]["horizontal"]);
+    sprite.spriteTypeId = getSpriteTypeId("player");
     ecs.addComponent(playerID, sprite);
 
     // Add Collider component
@@ -66,7 +79,7 @@ EntityID EntityFactory::createPlayer(ECS &ecs)
     ecs.addComponent(playerID, PlayerTag{});
 
     // Add EntityType
-    ecs.addComponent(playerID, EntityType("player"));
+    ecs.addComponent(playerID, EntityType(typeRegistry.find("player")));
 
     return playerID;
 }
@@ -90,6 +103,7 @@ EntityID EntityFactory::createMob(ECS &ecs, const std::string &mobType)
 
     // Add Sprite component
     Sprite sprite = createSpriteFromJSON(mobConfig["sprite"]);
+    sprite.spriteTypeId = getSpriteTypeId(mobType);
     ecs.addComponent(mobID, sprite);
 
     // Add Collider component
@@ -114,7 +128,7 @@ EntityID EntityFactory::createMob(ECS &ecs, const std::string &mobType)
     ecs.addComponent(mobID, MobTag{});
 
     // Add EntityType
-    ecs.addComponent(mobID, EntityType(mobType));
+    ecs.addComponent(mobID, EntityType(typeRegistry.find(mobType)));
 
     return mobID;
 }
@@ -139,11 +153,132 @@ EntityID EntityFactory::createUIElement(ECS &ecs, const std::string &uiType)
     ecs.addComponent(uiID, uiText);
 
     // Add EntityType
-    ecs.addComponent(uiID, EntityType(uiType));
+    ecs.addComponent(uiID, EntityType(typeRegistry.find(uiType)));
 
     return uiID;
 }
 
+std::vector<std::string> EntityFactory::getSpriteFramePaths() const
+{
+    std::vector<std::string> paths;
+
+    if (entityConfig.contains("player") && entityConfig["player"].contains("sprites"))
+    {
+        for (const auto &[direction, spriteConfig] : entityConfig["player"]["sprites"].items())
+        {
+            auto frames = getFramePathsFromJSON(spriteConfig);
+            paths.insert(paths.end(), frames.begin(), frames.end());
+        }
+    }
+
+    if (entityConfig.contains("mobs"))
+    {
+        for (const auto &[mobType, mobConfig] : entityConfig["mobs"].items())
+        {
+            if (mobConfig.contains("sprite"))
+            {
+                auto frames = getFramePathsFromJSON(mobConfig["sprite"]);
+                paths.insert(paths.end(), frames.begin(), frames.end());
+            }
+        }
+    }
+
+    return paths;
+}
+
+bool EntityFactory::registerSpriteClips()
+{
+    bool ok = true;
+
+    // Player: separate clips per direction, mirrored vertically when moving down
+    if (entityConfig.contains("player") && entityConfig["player"].contains("sprites"))
+    {
+        const json &sprites = entityConfig["player"]["sprites"];
+        int typeId = resourceManager->registerSpriteType("player");
+
+        if (sprites.contains("horizontal"))
+        {
+            ok &= resourceManager->setSpriteClip(typeId, MovementDirection::HORIZONTAL,
+                                                 getFramePathsFromJSON(sprites["horizontal"]),
+                                                 SDL_FLIP_NONE, SDL_FLIP_NONE);
+        }
+        if (sprites.contains("vertical"))
+        {
+            ok &= resourceManager->setSpriteClip(typeId, MovementDirection::VERTICAL,
+                                                 getFramePathsFromJSON(sprites["vertical"]),
+                                                 SDL_FLIP_NONE, SDL_FLIP_VERTICAL);
+        }
+    }
+
+    // Mobs: one clip for both directions; art faces right/down by default
+    if (entityConfig.contains("mobs"))
+    {
+        for (const auto &[mobType, mobConfig] : entityConfig["mobs"].items())
+        {
+            if (!mobConfig.contains("sprite"))
+                continue;
+
+            int typeId = resourceManager->registerSpriteType(mobType);
+            std::vector<std::string> frames = getFramePathsFromJSON(mobConfig["sprite"]);
+            ok &= resourceManager->setSpriteClip(typeId, MovementDirection::HORIZONTAL, frames,
+                                                 SDL_FLIP_HORIZONTAL, SDL_FLIP_NONE);
+            ok &= resourceManager->setSpriteClip(typeId, MovementDirection::VERTICAL, frames,
+                                                 SDL_FLIP_VERTICAL, SDL_FLIP_NONE);
+        }
+    }
+
+    return ok;
+}
+
+int EntityFactory::getSpriteTypeId(const std::string &type) const
+{
+    return resourceManager->getSpriteTypeId(type);
+}
+
+TextureHandle EntityFactory::resolveTexture(const std::string &path)
+{
+    auto it = textureHandles.find(path);
+    if (it != textureHandles.end())
+        return it->second;
+
+    TextureHandle handle = resourceManager->loadTexture(path);
+    if (handle.isValid())
+        textureHandles[path] = handle;
+    return handle;
+}
+
+FontHandle EntityFactory::resolveFont(const std::string &path, int fontSize)
+{
+    std::string key = path + "_" + std::to_string(fontSize);
+    auto it = fontHandles.find(key);
+    if (it != fontHandles.end())
+        return it->second;
+
+    FontHandle handle = resourceManager->loadFont(path, fontSize);
+    if (handle.isValid())
+        fontHandles[key] = handle;
+    return handle;
+}
+
+std::vector<std::string> EntityFactory::getFramePathsFromJSON(const json &spriteConfig) const
+{
+    std::vector<std::string> paths;
+
+    if (spriteConfig.contains("frames"))
+    {
+        for (const auto &frame : spriteConfig["frames"])
+        {
+            paths.push_back(frame.get<std::string>());
+        }
+    }
+    else if (spriteConfig.contains("texture"))
+    {
+        paths.push_back(spriteConfig["texture"].get<std::string>());
+    }
+
+    return paths;
+}
+
 Transform EntityFactory::createTransformFromJSON(const json &config, const json &positionOverride)
 {
     float x = 0, y = 0, rotation = 0;
@@ -169,8 +304,12 @@ Transform EntityFactory::createTransformFromJSON(const json &config, const json
 
 Sprite EntityFactory::createSpriteFromJSON(const json &config)
 {
+    // A texture packed into the atlas is drawn through the sprite's clip; loading it
+    // standalone as well would decode it synchronously and keep a second copy in VRAM
     std::string texturePath = config["texture"].get<std::string>();
-    SDL_Texture *texture = resourceManager->loadTexture(texturePath);
+    TextureHandle texture;
+    if (!resourceManager->getAtlasRegion(texturePath))
+        texture = resolveTexture(texturePath);
 
     int width = config["width"].get<int>();
     int height = config["height"].get<int>();
@@ -198,8 +337,7 @@ Speed EntityFactory::createSpeedFromJSON(const json &config)
 UIText EntityFactory::createUITextFromJSON(const json &config)
 {
     std::string text = config["text"].get<std::string>();
-    std::string font = config["font"].get<std::string>();
-    int fontSize = config["fontSize"].get<int>();
+    FontHandle font = resolveFont(config["font"].get<std::string>(), config["fontSize"].get<int>());
 
     SDL_Color color = {255, 255, 255, 255}; // Default white
     if (config.contains("color"))
@@ -210,7 +348,7 @@ UIText EntityFactory::createUITextFromJSON(const json &config)
         color.a = config["color"]["a"].get<Uint8>();
     }
 
-    return UIText(text, font, fontSize, color, true);
+    return UIText(text, font, color, true);
 }
 
 UIPosition EntityFactory::createUIPositionFromJSON(const json &config)
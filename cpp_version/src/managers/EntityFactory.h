@@ -1,8 +1,11 @@
 #pragma once
 #include "../core/ECS.h"
 #include "../components/Components.h"
+#include "../core/EntityTypeRegistry.h"
 #include <nlohmann/json.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 class ResourceManager; // Forward declaration
 
@@ -13,9 +16,17 @@ class EntityFactory
 private:
     json entityConfig;
     ResourceManager *resourceManager;
+    EntityTypeRegistry typeRegistry; // Every type name in the config, interned at load
+
+    // Resources resolved once from config paths; the factory holds one reference to each
+    std::unordered_map<std::string, TextureHandle> textureHandles;
+    std::unordered_map<std::string, FontHandle> fontHandles;
 
 public:
-    EntityFactory(ResourceManager *rm) : resourceManager(rm) {}
+    EntityFactory(ResourceManager *rm = nullptr) : resourceManager(rm) {}
+
+    // The configuration can load before the renderer exists; set this before creating entities
+    void setResourceManager(ResourceManager *rm) { resourceManager = rm; }
 
     // Load entity configuration from JSON file
     bool loadConfig(const std::string &configFile);
@@ -25,16 +36,32 @@ public:
     EntityID createMob(ECS &ecs, const std::string &mobType);
     EntityID createUIElement(ECS &ecs, const std::string &uiType);
 
+    // Interned entity type IDs (names are registered by loadConfig)
+    EntityTypeId getTypeId(const std::string &name) const { return typeRegistry.find(name); }
+    const EntityTypeRegistry &getTypeRegistry() const { return typeRegistry; }
+
     // Get game settings from JSON
     json getGameSettings() const { return entityConfig["gameSettings"]; }
 
     // Get full entity configuration
     json getEntityConfig() const { return entityConfig; }
 
+    // Collect every sprite frame path referenced by the configuration (for atlas packing)
+    std::vector<std::string> getSpriteFramePaths() const;
+
+    // Resolve player/mob animation clips into ResourceManager's clip tables (after atlas packing)
+    bool registerSpriteClips();
+    int getSpriteTypeId(const std::string &type) const;
+
+    // Handle for a config path, loading it on first use
+    TextureHandle resolveTexture(const std::string &path);
+    FontHandle resolveFont(const std::string &path, int fontSize);
+
 private:
     // Helper methods for creating components from JSON
     Transform createTransformFromJSON(const json &config, const json &positionOverride = json::object());
     Sprite createSpriteFromJSON(const json &config);
+    std::vector<std::string> getFramePathsFromJSON(const json &spriteConfig) const;
     Collider createColliderFromJSON(const json &config);
     Speed createSpeedFromJSON(const json &config);
     UIText createUITextFromJSON(const json &config);
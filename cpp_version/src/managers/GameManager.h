@@ -20,6 +20,10 @@ public:
     float screenWidth = 480;
     float screenHeight = 720;
 
+    // World bounds (may be larger than the screen; the camera scrolls over it)
+    float worldWidth = 480;
+    float worldHeight = 720;
+
     // Game settings (will be loaded from JSON later)
     float mobSpawnInterval = 0.5f;
     float scorePerSecond = 10.0f;
@@ -0,0 +1,21 @@
+#pragma once
+
+// Typed index into a resource table (textures and fonts in ResourceManager, sounds and
+// music in AudioSystem). A path is resolved to a handle once at load; every later lookup is an
+// array index. Handles are released through the table that issued them, and a handle
+// must not be used after its last release (the slot may be reused).
+template <typename Tag>
+struct ResourceHandle
+{
+    static constexpr int INVALID = -1;
+    int index = INVALID;
+
+    bool isValid() const { return index >= 0; }
+    bool operator==(const ResourceHandle &other) const { return index == other.index; }
+    bool operator!=(const ResourceHandle &other) const { return index != other.index; }
+};
+
+using TextureHandle = ResourceHandle<struct TextureHandleTag>;
+using FontHandle = ResourceHandle<struct FontHandleTag>;
+using SoundHandle = ResourceHandle<struct SoundHandleTag>;
+using MusicHandle = ResourceHandle<struct MusicHandleTag>;
@@ -1,93 +1,1022 @@
 #include "ResourceManager.h"
+#include "../core/Profiler.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
-ResourceManager::ResourceManager(SDL_Renderer *renderer) : renderer(renderer) {}
+ResourceManager::ResourceManager(SDL_Renderer *renderer, int loaderThreads)
+    : renderer(renderer), loader(std::make_unique<AssetLoader>(loaderThreads)) {}
 
 ResourceManager::~ResourceManager()
 {
     cleanup();
 }
 
-SDL_Texture *ResourceManager::loadTexture(const std::string &path)
+template <typename Slot>
+int ResourceManager::allocateSlot(std::vector<Slot> &slots, std::vector<int> &freeSlots)
 {
-    // Check if texture is already loaded
-    auto it = textures.find(path);
-    if (it != textures.end())
+    // Reuse released slots so the tables stay dense
+    if (!freeSlots.empty())
     {
-        return it->second;
+        int index = freeSlots.back();
+        freeSlots.pop_back();
+        slots[index] = Slot();
+        return index;
     }
+    slots.emplace_back();
+    return static_cast<int>(slots.size()) - 1;
+}
+
+TextureHandle ResourceManager::loadTexture(const std::string &path)
+{
+    TextureHandle handle;
+
+    // Check if texture is already loaded (or requested)
+    auto it = textureIndices.find(path);
+    if (it != textureIndices.end())
+    {
+        handle.index = it->second;
+        TextureSlot &slot = textureSlots[handle.index];
+        slot.refCount++;
+
+        // Evicted, or still decoding on a worker, but needed now: load it here
+        // (a worker's result for it is then dropped)
+        if (!slot.texture && (slot.ticket >= 0 || slot.evicted))
+        {
+            textureStats.misses++;
+            finishTextureLoad(handle.index, decodeTexture(path));
+        }
+        else if (slot.texture)
+        {
+            textureStats.hits++;
+        }
+        return handle;
+    }
+
+    textureStats.misses++;
+    SDL_Texture *texture = decodeTexture(path);
+    if (!texture)
+        return handle;
 
+    handle.index = allocateSlot(textureSlots, freeTextureSlots);
+    TextureSlot &slot = textureSlots[handle.index];
+    slot.path = path;
+    slot.refCount = 1;
+    textureIndices[path] = handle.index;
+    finishTextureLoad(handle.index, texture);
+    return handle;
+}
+
+SDL_Texture *ResourceManager::decodeTexture(const std::string &path)
+{
     // Construct full path to asset
     std::string fullPath = std::string(ASSET_PATH) + path;
 
-    // Load new texture
-    SDL_Texture *texture = IMG_LoadTexture(renderer, fullPath.c_str());
+    SDL_Texture *texture = nullptr;
+    if (SDL_Surface *bundled = createBundledSurface(path))
+    {
+        // Already decoded in the bundle: upload straight from the mapped pixels
+        texture = createTexture(bundled);
+        SDL_FreeSurface(bundled);
+    }
+    else if (retainPixels)
+    {
+        // Decode to a surface first so the pixels can be kept for the CPU backend
+        SDL_Surface *rgba = AssetLoader::decodeImage(path);
+        if (rgba)
+        {
+            texture = createTexture(rgba);
+            SDL_FreeSurface(rgba);
+        }
+    }
+    else
+    {
+        texture = IMG_LoadTexture(renderer, fullPath.c_str());
+    }
+
     if (!texture)
     {
         std::cerr << "Failed to load texture: " << fullPath << " - " << IMG_GetError() << std::endl;
-        return nullptr;
     }
+    return texture;
+}
+
+void ResourceManager::releaseTexture(TextureHandle handle)
+{
+    if (!isLive(handle, textureSlots))
+        return;
+
+    TextureSlot &slot = textureSlots[handle.index];
+    if (--slot.refCount > 0)
+        return;
+
+    // Last reference: an in-flight decode is discarded when it arrives
+    if (slot.texture)
+    {
+        destroyTexture(slot.texture);
+        textureStats.residentBytes -= slot.bytes;
+        textureStats.residentTextures--;
+    }
+    textureIndices.erase(slot.path);
+    pendingClipFrames.erase(std::remove_if(pendingClipFrames.begin(), pendingClipFrames.end(),
+                                           [handle](const std::pair<TextureHandle, int> &pending)
+                                           { return pending.first == handle; }),
+                            pendingClipFrames.end());
+    slot = TextureSlot();
+    freeTextureSlots.push_back(handle.index);
+}
 
-    textures[path] = texture;
+SDL_Texture *ResourceManager::createTexture(SDL_Surface *rgba)
+{
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, rgba);
+    if (texture)
+        retainSurfacePixels(texture, rgba);
     return texture;
 }
 
-SDL_Texture *ResourceManager::getTexture(const std::string &path)
+SDL_Surface *ResourceManager::createBundledSurface(const std::string &path) const
 {
-    auto it = textures.find(path);
-    return it != textures.end() ? it->second : nullptr;
+    const AssetBundle::Entry *entry = bundle ? bundle->find(path, AssetBundle::TEXTURE) : nullptr;
+    return entry ? AssetBundle::createSurface(*entry) : nullptr;
 }
 
-void ResourceManager::unloadTexture(const std::string &path)
+TextureHandle ResourceManager::requestTexture(const std::string &path)
 {
-    auto it = textures.find(path);
-    if (it != textures.end())
+    // Already loaded or requested: share the slot (an evicted texture is reloaded
+    // by the next processUploads())
+    auto it = textureIndices.find(path);
+    if (it != textureIndices.end())
     {
-        SDL_DestroyTexture(it->second);
-        textures.erase(it);
+        TextureSlot &slot = textureSlots[it->second];
+        slot.refCount++;
+        slot.lastUsedFrame = currentFrame;
+        return TextureHandle{it->second};
     }
+
+    // Bundled textures need no decoding, so they are ready straight away
+    if (bundle && bundle->find(path, AssetBundle::TEXTURE))
+    {
+        TextureHandle handle = loadTexture(path);
+        if (handle.isValid())
+            return handle;
+    }
+
+    TextureHandle handle;
+    handle.index = allocateSlot(textureSlots, freeTextureSlots);
+    TextureSlot &slot = textureSlots[handle.index];
+    slot.path = path;
+    slot.refCount = 1;
+    slot.ticket = loader->enqueue(path);
+    slot.lastUsedFrame = currentFrame;
+    textureIndices[path] = handle.index;
+    return handle;
 }
 
-TTF_Font *ResourceManager::loadFont(const std::string &path, int fontSize)
+size_t ResourceManager::getPendingUploadCount() const
 {
+    size_t pending = 0;
+    for (const auto &slot : textureSlots)
+    {
+        if (slot.refCount > 0 && slot.ticket >= 0)
+            pending++;
+    }
+    return pending;
+}
+
+void ResourceManager::finishTextureLoad(int index, SDL_Texture *texture)
+{
+    TextureSlot &slot = textureSlots[index];
+    slot.texture = texture;
+    slot.ticket = -1;
+    slot.failed = texture == nullptr;
+    slot.evicted = false;
+    slot.lastUsedFrame = currentFrame; // A fresh load is not an eviction candidate straight away
+
+    if (texture)
+    {
+        int width = 0, height = 0;
+        SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+        slot.bytes = static_cast<size_t>(width) * height * 4;
+        if (retainPixels)
+            slot.bytes *= 2; // CPU copy for the software backend
+        textureStats.residentBytes += slot.bytes;
+        textureStats.residentTextures++;
+    }
+
+    // Clip frames that were waiting on this texture now draw it whole
+    for (auto it = pendingClipFrames.begin(); it != pendingClipFrames.end();)
+    {
+        if (it->first.index != index)
+        {
+            ++it;
+            continue;
+        }
+        AtlasRegion &region = clipFrames[it->second];
+        region.texture = texture;
+        if (texture)
+            SDL_QueryTexture(texture, nullptr, nullptr, &region.rect.w, &region.rect.h);
+        it = pendingClipFrames.erase(it);
+    }
+}
+
+void ResourceManager::evictTexture(int index)
+{
+    destroyTexture(textureSlots[index].texture);
+    dropResidentTexture(index);
+    textureStats.evictions++;
+}
+
+void ResourceManager::dropResidentTexture(int index)
+{
+    TextureSlot &slot = textureSlots[index];
+    slot.texture = nullptr;
+    slot.evicted = true;
+    textureStats.residentBytes -= slot.bytes;
+    textureStats.residentTextures--;
+
+    // Clip frames drawing it wait for the reload like a streamed-in texture
+    for (size_t i = 0; i < clipFrames.size(); ++i)
+    {
+        if (clipFrames[i].source.index == index)
+        {
+            clipFrames[i].texture = nullptr;
+            pendingClipFrames.push_back({clipFrames[i].source, static_cast<int>(i)});
+        }
+    }
+}
+
+void ResourceManager::enforceTextureBudget()
+{
+    if (textureStats.budgetBytes == 0 || textureStats.residentBytes <= textureStats.budgetBytes)
+        return;
+
+    // Least recently used first, skipping anything a snapshot in flight may still draw
+    std::vector<int> candidates;
+    for (size_t i = 0; i < textureSlots.size(); ++i)
+    {
+        const TextureSlot &slot = textureSlots[i];
+        if (slot.texture && slot.lastUsedFrame + EVICTION_MIN_AGE <= currentFrame)
+            candidates.push_back(static_cast<int>(i));
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b)
+              { return textureSlots[a].lastUsedFrame < textureSlots[b].lastUsedFrame; });
+
+    for (int index : candidates)
+    {
+        if (textureStats.residentBytes <= textureStats.budgetBytes)
+            break;
+        evictTexture(index);
+    }
+}
+
+int ResourceManager::processUploads(float budgetMs)
+{
+    currentFrame++;
+
+    // Textures replaced after a device reset, once the snapshots that drew them are gone
+    for (auto it = retiredTextures.begin(); it != retiredTextures.end();)
+    {
+        if (it->second + EVICTION_MIN_AGE > currentFrame)
+        {
+            ++it;
+            continue;
+        }
+        destroyTexture(it->first);
+        it = retiredTextures.erase(it);
+    }
+
+    // Evicted textures drawn again since the last frame go back to the loader
+    // (bundled ones need no decode and are recreated right here)
+    for (size_t i = 0; i < textureSlots.size(); ++i)
+    {
+        TextureSlot &slot = textureSlots[i];
+        if (!slot.evicted || slot.ticket >= 0 || slot.lastUsedFrame + 1 < currentFrame)
+            continue;
+        if (bundle && bundle->find(slot.path, AssetBundle::TEXTURE))
+            finishTextureLoad(static_cast<int>(i), decodeTexture(slot.path));
+        else
+            slot.ticket = loader->enqueue(slot.path);
+    }
+
+    AssetLoader::DecodedImage image;
+    while (loader->pollDecoded(image))
+    {
+        pendingUploads.push_back(std::move(image));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int uploaded = 0;
+    while (!pendingUploads.empty())
+    {
+        // Always make progress, then stop once the frame's budget is spent
+        float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (uploaded > 0 && elapsedMs >= budgetMs)
+            break;
+
+        AssetLoader::DecodedImage decoded = std::move(pendingUploads.front());
+        pendingUploads.pop_front();
+
+        // Results of a decodeAll() batch, a released texture or one a synchronous
+        // load already finished carry a ticket the slot no longer waits on
+        auto indexIt = textureIndices.find(decoded.path);
+        if (indexIt == textureIndices.end() || textureSlots[indexIt->second].ticket != decoded.ticket)
+        {
+            if (decoded.surface)
+                SDL_FreeSurface(decoded.surface);
+            continue;
+        }
+
+        SDL_Texture *texture = nullptr;
+        if (decoded.surface)
+        {
+            texture = createTexture(decoded.surface);
+            if (!texture)
+                std::cerr << "Failed to upload texture: " << decoded.path << " - " << SDL_GetError() << std::endl;
+            SDL_FreeSurface(decoded.surface);
+        }
+
+        finishTextureLoad(indexIt->second, texture);
+        uploaded++;
+    }
+
+    enforceTextureBudget();
+
+    return uploaded;
+}
+
+const TexturePixels *ResourceManager::getTexturePixels(SDL_Texture *texture) const
+{
+    auto it = texturePixels.find(texture);
+    return it != texturePixels.end() ? &it->second : nullptr;
+}
+
+void ResourceManager::retainSurfacePixels(SDL_Texture *texture, SDL_Surface *surface)
+{
+    if (!retainPixels || !texture || !surface)
+        return;
+
+    // Callers hand in RGBA32 surfaces; copy row by row to drop the pitch
+    TexturePixels copy;
+    copy.width = surface->w;
+    copy.height = surface->h;
+    copy.pixels.resize(static_cast<size_t>(surface->w) * surface->h);
+
+    SDL_LockSurface(surface);
+    const Uint8 *row = static_cast<const Uint8 *>(surface->pixels);
+    for (int y = 0; y < surface->h; ++y)
+    {
+        std::copy_n(reinterpret_cast<const Uint32 *>(row + y * surface->pitch), surface->w,
+                    copy.pixels.begin() + static_cast<size_t>(y) * surface->w);
+    }
+    SDL_UnlockSurface(surface);
+
+    texturePixels[texture] = std::move(copy);
+}
+
+void ResourceManager::destroyTexture(SDL_Texture *texture)
+{
+    texturePixels.erase(texture);
+    SDL_DestroyTexture(texture);
+}
+
+void ResourceManager::retireTexture(SDL_Texture *texture)
+{
+    if (texture)
+        retiredTextures.push_back({texture, currentFrame});
+}
+
+SDL_Surface *ResourceManager::createRetainedSurface(SDL_Texture *texture) const
+{
+    const TexturePixels *pixels = getTexturePixels(texture);
+    if (!pixels)
+        return nullptr;
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, pixels->width, pixels->height, 32,
+                                                          SDL_PIXELFORMAT_RGBA32);
+    if (!surface)
+        return nullptr;
+    SDL_LockSurface(surface);
+    Uint8 *row = static_cast<Uint8 *>(surface->pixels);
+    for (int y = 0; y < pixels->height; ++y)
+    {
+        std::copy_n(pixels->pixels.begin() + static_cast<size_t>(y) * pixels->width, pixels->width,
+                    reinterpret_cast<Uint32 *>(row + y * surface->pitch));
+    }
+    SDL_UnlockSurface(surface);
+    return surface;
+}
+
+void ResourceManager::recreateDeviceTextures()
+{
+    // Atlas pages keep their layout; regions and clip frames are pointed at the new page
+    for (SDL_Texture *&page : atlasPages)
+    {
+        SDL_Surface *pageSurface = createRetainedSurface(page);
+        if (!pageSurface)
+            pageSurface = composeAtlasPage(page);
+
+        SDL_Texture *replacement = pageSurface ? SDL_CreateTextureFromSurface(renderer, pageSurface) : nullptr;
+        if (replacement)
+        {
+            retainSurfacePixels(replacement, pageSurface);
+            SDL_SetTextureBlendMode(replacement, SDL_BLENDMODE_BLEND);
+        }
+        else
+        {
+            std::cerr << "Failed to recreate atlas page texture: " << SDL_GetError() << std::endl;
+        }
+        if (pageSurface)
+            SDL_FreeSurface(pageSurface);
+
+        for (auto &[path, region] : atlasRegions)
+        {
+            if (region.texture == page)
+                region.texture = replacement;
+        }
+        for (auto &frame : clipFrames)
+        {
+            if (frame.texture == page)
+                frame.texture = replacement;
+        }
+        retireTexture(page);
+        page = replacement;
+    }
+
+    // Standalone textures go back through the eviction reload path
+    for (size_t i = 0; i < textureSlots.size(); ++i)
+    {
+        if (!textureSlots[i].texture)
+            continue;
+        retireTexture(textureSlots[i].texture);
+        dropResidentTexture(static_cast<int>(i));
+    }
+
+    // Glyph atlases keep their layout; getGlyphAtlas() uploads the retained pixels
+    // or rasterises the glyphs again
+    for (auto &slot : fontSlots)
+    {
+        if (!slot.glyphAtlas.texture)
+            continue;
+        if (!slot.glyphSurface)
+            slot.glyphSurface = createRetainedSurface(slot.glyphAtlas.texture);
+        retireTexture(slot.glyphAtlas.texture);
+        slot.glyphAtlas.texture = nullptr;
+    }
+
+    std::cout << "Render device reset: recreated " << atlasPages.size() << " atlas page(s), "
+              << retiredTextures.size() << " textures retired" << std::endl;
+}
+
+bool ResourceManager::buildSpriteAtlas(const std::vector<std::string> &paths)
+{
+    destroyAtlas();
+
+    // Decode every frame into an RGBA surface first so we know the sizes
+    struct PendingFrame
+    {
+        std::string path;
+        SDL_Surface *surface;
+        int page;
+        SDL_Rect rect;
+    };
+    std::vector<PendingFrame> frames;
+
+    std::vector<std::string> uniquePaths;
+    for (const auto &path : paths)
+    {
+        if (std::find(uniquePaths.begin(), uniquePaths.end(), path) == uniquePaths.end())
+            uniquePaths.push_back(path);
+    }
+
+    // Bundled frames wrap the mapped pixels; the rest are decoded in parallel on the loader workers
+    std::vector<SDL_Surface *> decoded(uniquePaths.size(), nullptr);
+    std::vector<std::string> decodePaths;
+    std::vector<size_t> decodeSlots;
+    for (size_t i = 0; i < uniquePaths.size(); ++i)
+    {
+        decoded[i] = createBundledSurface(uniquePaths[i]);
+        if (!decoded[i])
+        {
+            decodePaths.push_back(uniquePaths[i]);
+            decodeSlots.push_back(i);
+        }
+    }
+    if (!decodePaths.empty())
+    {
+        std::vector<SDL_Surface *> results = loader->decodeAll(decodePaths);
+        for (size_t i = 0; i < results.size(); ++i)
+            decoded[decodeSlots[i]] = results[i];
+    }
+
+    for (size_t i = 0; i < uniquePaths.size(); ++i)
+    {
+        const std::string &path = uniquePaths[i];
+        SDL_Surface *rgba = decoded[i];
+        if (!rgba)
+            continue;
+
+        // Frames that can never fit a page keep using a standalone texture
+        if (rgba->w + ATLAS_PADDING * 2 > ATLAS_PAGE_SIZE || rgba->h + ATLAS_PADDING * 2 > ATLAS_PAGE_SIZE)
+        {
+            SDL_FreeSurface(rgba);
+            continue;
+        }
+
+        frames.push_back({path, rgba, 0, {0, 0, rgba->w, rgba->h}});
+    }
+
+    if (frames.empty())
+        return false;
+
+    // Shelf packing: tallest frames first keeps shelves tight
+    std::vector<PendingFrame *> order;
+    for (auto &frame : frames)
+        order.push_back(&frame);
+    std::sort(order.begin(), order.end(),
+              [](const PendingFrame *a, const PendingFrame *b) { return a->rect.h > b->rect.h; });
+
+    int page = 0;
+    int cursorX = 0, cursorY = 0, shelfHeight = 0;
+    for (auto *frame : order)
+    {
+        int paddedW = frame->rect.w + ATLAS_PADDING * 2;
+        int paddedH = frame->rect.h + ATLAS_PADDING * 2;
+
+        if (cursorX + paddedW > ATLAS_PAGE_SIZE)
+        {
+            // Start a new shelf
+            cursorX = 0;
+            cursorY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (cursorY + paddedH > ATLAS_PAGE_SIZE)
+        {
+            // Start a new page
+            page++;
+            cursorX = 0;
+            cursorY = 0;
+            shelfHeight = 0;
+        }
+
+        frame->page = page;
+        frame->rect.x = cursorX + ATLAS_PADDING;
+        frame->rect.y = cursorY + ATLAS_PADDING;
+        cursorX += paddedW;
+        shelfHeight = std::max(shelfHeight, paddedH);
+    }
+
+    // Compose each page on the CPU and upload it once
+    int pageCount = page + 1;
+    for (int p = 0; p < pageCount; ++p)
+    {
+        SDL_Surface *pageSurface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 32,
+                                                                  SDL_PIXELFORMAT_RGBA32);
+        if (!pageSurface)
+        {
+            std::cerr << "Failed to create atlas page surface: " << SDL_GetError() << std::endl;
+            break;
+        }
+        SDL_FillRect(pageSurface, nullptr, 0);
+
+        for (auto &frame : frames)
+        {
+            if (frame.page != p)
+                continue;
+            SDL_SetSurfaceBlendMode(frame.surface, SDL_BLENDMODE_NONE);
+            SDL_Rect dest = frame.rect;
+            SDL_BlitSurface(frame.surface, nullptr, pageSurface, &dest);
+        }
+
+        SDL_Texture *pageTexture = SDL_CreateTextureFromSurface(renderer, pageSurface);
+        retainSurfacePixels(pageTexture, pageSurface);
+        SDL_FreeSurface(pageSurface);
+        if (!pageTexture)
+        {
+            std::cerr << "Failed to create atlas page texture: " << SDL_GetError() << std::endl;
+            break;
+        }
+        SDL_SetTextureBlendMode(pageTexture, SDL_BLENDMODE_BLEND);
+        atlasPages.push_back(pageTexture);
+
+        for (auto &frame : frames)
+        {
+            if (frame.page != p)
+                continue;
+            AtlasRegion region;
+            region.texture = pageTexture;
+            region.rect = frame.rect;
+            region.u0 = static_cast<float>(frame.rect.x) / ATLAS_PAGE_SIZE;
+            region.v0 = static_cast<float>(frame.rect.y) / ATLAS_PAGE_SIZE;
+            region.u1 = static_cast<float>(frame.rect.x + frame.rect.w) / ATLAS_PAGE_SIZE;
+            region.v1 = static_cast<float>(frame.rect.y + frame.rect.h) / ATLAS_PAGE_SIZE;
+            atlasRegions[frame.path] = region;
+        }
+    }
+
+    for (auto &frame : frames)
+    {
+        SDL_FreeSurface(frame.surface);
+    }
+
+    std::cout << "Packed " << atlasRegions.size() << " sprite frames into "
+              << atlasPages.size() << " atlas page(s)" << std::endl;
+    return !atlasPages.empty();
+}
+
+SDL_Surface *ResourceManager::composeAtlasPage(SDL_Texture *page)
+{
+    // Decode the frames packed into this page again and blit them where they were
+    std::vector<std::string> paths;
+    std::vector<SDL_Rect> rects;
+    for (const auto &[path, region] : atlasRegions)
+    {
+        if (region.texture == page)
+        {
+            paths.push_back(path);
+            rects.push_back(region.rect);
+        }
+    }
+
+    std::vector<SDL_Surface *> decoded(paths.size(), nullptr);
+    std::vector<std::string> decodePaths;
+    std::vector<size_t> decodeSlots;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        decoded[i] = createBundledSurface(paths[i]);
+        if (!decoded[i])
+        {
+            decodePaths.push_back(paths[i]);
+            decodeSlots.push_back(i);
+        }
+    }
+    if (!decodePaths.empty())
+    {
+        std::vector<SDL_Surface *> results = loader->decodeAll(decodePaths);
+        for (size_t i = 0; i < results.size(); ++i)
+            decoded[decodeSlots[i]] = results[i];
+    }
+
+    SDL_Surface *pageSurface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 32,
+                                                              SDL_PIXELFORMAT_RGBA32);
+    if (pageSurface)
+        SDL_FillRect(pageSurface, nullptr, 0);
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        if (!decoded[i])
+            continue;
+        if (pageSurface)
+        {
+            SDL_SetSurfaceBlendMode(decoded[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dest = rects[i];
+            SDL_BlitSurface(decoded[i], nullptr, pageSurface, &dest);
+        }
+        SDL_FreeSurface(decoded[i]);
+    }
+    return pageSurface;
+}
+
+const AtlasRegion *ResourceManager::getAtlasRegion(const std::string &path) const
+{
+    auto it = atlasRegions.find(path);
+    return it != atlasRegions.end() ? &it->second : nullptr;
+}
+
+int ResourceManager::registerSpriteType(const std::string &name)
+{
+    int existing = getSpriteTypeId(name);
+    if (existing >= 0)
+        return existing;
+
+    spriteTypeNames.push_back(name);
+    spriteClips.resize(spriteTypeNames.size() * SPRITE_DIRECTIONS);
+    return static_cast<int>(spriteTypeNames.size()) - 1;
+}
+
+int ResourceManager::getSpriteTypeId(const std::string &name) const
+{
+    for (size_t i = 0; i < spriteTypeNames.size(); ++i)
+    {
+        if (spriteTypeNames[i] == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool ResourceManager::setSpriteClip(int typeId, int direction, const std::vector<std::string> &framePaths,
+                                    SDL_RendererFlip flipWhenNegative, SDL_RendererFlip flipWhenPositive)
+{
+    if (typeId < 0 || typeId >= static_cast<int>(spriteTypeNames.size()) ||
+        direction < 0 || direction >= SPRITE_DIRECTIONS)
+    {
+        return false;
+    }
+
+    SpriteClip clip;
+    clip.firstFrame = static_cast<int>(clipFrames.size());
+    clip.flipWhenNegative = flipWhenNegative;
+    clip.flipWhenPositive = flipWhenPositive;
+
+    for (const auto &path : framePaths)
+    {
+        const AtlasRegion *atlased = getAtlasRegion(path);
+        if (atlased)
+        {
+            clipFrames.push_back(*atlased);
+            continue;
+        }
+
+        // Not in the atlas: the standalone texture acts as a single-region page. It is
+        // streamed in; until it is uploaded the frame has no texture and is not drawn.
+        TextureHandle handle = requestTexture(path);
+        clipTextures.push_back(handle);
+        SDL_Texture *texture = getTexture(handle);
+
+        AtlasRegion region;
+        region.texture = texture;
+        region.rect = {0, 0, 0, 0};
+        if (texture)
+            SDL_QueryTexture(texture, nullptr, nullptr, &region.rect.w, &region.rect.h);
+        else
+            pendingClipFrames.push_back({handle, static_cast<int>(clipFrames.size())});
+        region.u0 = 0.0f;
+        region.v0 = 0.0f;
+        region.u1 = 1.0f;
+        region.v1 = 1.0f;
+        region.source = handle;
+        clipFrames.push_back(region);
+    }
+
+    clip.frameCount = static_cast<int>(clipFrames.size()) - clip.firstFrame;
+    spriteClips[typeId * SPRITE_DIRECTIONS + direction] = clip;
+    return clip.frameCount > 0;
+}
+
+void ResourceManager::destroyAtlas()
+{
+    for (auto *page : atlasPages)
+    {
+        destroyTexture(page);
+    }
+    atlasPages.clear();
+    atlasRegions.clear();
+
+    // Clip frames point into the atlas pages, so they go with them
+    spriteTypeNames.clear();
+    spriteClips.clear();
+    clipFrames.clear();
+    pendingClipFrames.clear();
+    for (TextureHandle handle : clipTextures)
+    {
+        releaseTexture(handle);
+    }
+    clipTextures.clear();
+}
+
+FontHandle ResourceManager::loadFont(const std::string &path, int fontSize)
+{
+    FontHandle handle;
     std::string key = getFontKey(path, fontSize);
 
     // Check if font is already loaded
-    auto it = fonts.find(key);
-    if (it != fonts.end())
+    auto it = fontIndices.find(key);
+    if (it != fontIndices.end())
     {
-        return it->second;
+        handle.index = it->second;
+        fontSlots[handle.index].refCount++;
+        return handle;
     }
 
-    // Load new font
-    std::string fullPath = std::string(ASSET_PATH) + path;
-    TTF_Font *font = TTF_OpenFont(fullPath.c_str(), fontSize);
-    if (!font)
+    // Take the font loader's copy when it opened this one, otherwise open it now
+    finishFontPreload();
+    PreloadedFont loaded;
+    auto preloaded = preloadedFonts.find(key);
+    if (preloaded != preloadedFonts.end())
+    {
+        loaded = std::move(preloaded->second);
+        preloadedFonts.erase(preloaded);
+    }
+    else
     {
-        std::cerr << "Failed to load font: " << fullPath << " - " << TTF_GetError() << std::endl;
+        loaded.font = openFont(path, fontSize, loaded.fileData);
+    }
+    if (!loaded.font)
+    {
+        std::cerr << "Failed to load font: " << ASSET_PATH << path << " - " << TTF_GetError() << std::endl;
+        return handle;
+    }
+
+    handle.index = allocateSlot(fontSlots, freeFontSlots);
+    FontSlot &slot = fontSlots[handle.index];
+    slot.path = path;
+    slot.size = fontSize;
+    slot.font = loaded.font;
+    slot.fileData = std::move(loaded.fileData);
+    slot.glyphAtlas = loaded.glyphAtlas;
+    slot.glyphSurface = loaded.glyphSurface;
+    slot.refCount = 1;
+    fontIndices[key] = handle.index;
+    return handle;
+}
+
+void ResourceManager::releaseFont(FontHandle handle)
+{
+    if (!isLive(handle, fontSlots))
+        return;
+
+    FontSlot &slot = fontSlots[handle.index];
+    if (--slot.refCount > 0)
+        return;
+
+    // The glyph atlas borrows the font for kerning, drop it first
+    destroyGlyphAtlas(slot.glyphAtlas);
+    if (slot.glyphSurface)
+        SDL_FreeSurface(slot.glyphSurface);
+    TTF_CloseFont(slot.font);
+    fontIndices.erase(getFontKey(slot.path, slot.size));
+    slot = FontSlot();
+    freeFontSlots.push_back(handle.index);
+}
+
+void ResourceManager::startFontPreload(const std::vector<std::pair<std::string, int>> &fonts)
+{
+    finishFontPreload();
+
+    // SDL_ttf may only be used by one thread at a time, so all fonts share this one
+    fontLoader = std::thread(&ResourceManager::preloadFonts, this, fonts);
+}
+
+void ResourceManager::preloadFonts(std::vector<std::pair<std::string, int>> fonts)
+{
+    Profiler::setThreadName("Font loader");
+    for (const auto &[path, size] : fonts)
+    {
+        std::string key = getFontKey(path, size);
+        if (preloadedFonts.count(key))
+            continue;
+
+        PROFILE_ZONE("Load font");
+        PreloadedFont loaded;
+        loaded.font = openFont(path, size, loaded.fileData);
+        if (!loaded.font)
+        {
+            std::cerr << "Failed to load font: " << ASSET_PATH << path << " - " << TTF_GetError() << std::endl;
+            continue;
+        }
+        loaded.glyphSurface = rasteriseGlyphs(loaded.font, loaded.glyphAtlas);
+        preloadedFonts[key] = std::move(loaded);
+    }
+}
+
+void ResourceManager::finishFontPreload()
+{
+    if (fontLoader.joinable())
+        fontLoader.join();
+}
+
+TTF_Font *ResourceManager::openFont(const std::string &path, int fontSize, std::vector<Uint8> &fileData) const
+{
+    // The bundle's copy of the file is read in place
+    const AssetBundle::Entry *entry = bundle ? bundle->find(path, AssetBundle::BLOB) : nullptr;
+    if (entry)
+        return TTF_OpenFontRW(AssetBundle::openStream(*entry), 1, fontSize);
+
+    // Loose files are read whole and parsed from memory, like the bundle;
+    // fileData has to outlive the font
+    if (!AssetLoader::readFile(path, fileData))
+        return nullptr;
+    return TTF_OpenFontRW(SDL_RWFromConstMem(fileData.data(), static_cast<int>(fileData.size())), 1, fontSize);
+}
+
+SDL_Surface *ResourceManager::rasteriseGlyphs(TTF_Font *font, GlyphAtlas &atlas)
+{
+    atlas.font = font;
+    atlas.lineHeight = TTF_FontHeight(font);
+
+    // Rasterise every glyph once in white and lay them out in rows
+    const SDL_Color white = {255, 255, 255, 255};
+    const int glyphCount = GlyphAtlas::LAST_CHAR - GlyphAtlas::FIRST_CHAR + 1;
+    std::vector<SDL_Surface *> surfaces(glyphCount, nullptr);
+
+    int cursorX = 0, cursorY = 0, rowHeight = atlas.lineHeight;
+    for (int i = 0; i < glyphCount; ++i)
+    {
+        Uint16 ch = static_cast<Uint16>(GlyphAtlas::FIRST_CHAR + i);
+        GlyphInfo &glyph = atlas.glyphs[i];
+
+        int advance = 0;
+        if (TTF_GlyphMetrics(font, ch, nullptr, nullptr, nullptr, nullptr, &advance) == 0)
+        {
+            glyph.advance = advance;
+        }
+
+        SDL_Surface *surface = (ch == ' ') ? nullptr : TTF_RenderGlyph_Blended(font, ch, white);
+        glyph.rect = {0, 0, 0, 0};
+        if (!surface)
+            continue;
+
+        if (cursorX + surface->w + ATLAS_PADDING * 2 > GLYPH_ATLAS_WIDTH)
+        {
+            cursorX = 0;
+            cursorY += rowHeight + ATLAS_PADDING * 2;
+            rowHeight = atlas.lineHeight;
+        }
+        rowHeight = std::max(rowHeight, surface->h);
+        glyph.rect = {cursorX + ATLAS_PADDING, cursorY + ATLAS_PADDING, surface->w, surface->h};
+        cursorX += surface->w + ATLAS_PADDING * 2;
+        surfaces[i] = surface;
+    }
+
+    int atlasHeight = cursorY + rowHeight + ATLAS_PADDING * 2;
+    SDL_Surface *atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, atlasHeight, 32,
+                                                               SDL_PIXELFORMAT_RGBA32);
+    if (atlasSurface)
+    {
+        SDL_FillRect(atlasSurface, nullptr, 0);
+        for (int i = 0; i < glyphCount; ++i)
+        {
+            if (!surfaces[i])
+                continue;
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dest = atlas.glyphs[i].rect;
+            SDL_BlitSurface(surfaces[i], nullptr, atlasSurface, &dest);
+        }
+    }
+
+    for (auto *surface : surfaces)
+    {
+        if (surface)
+            SDL_FreeSurface(surface);
+    }
+
+    for (auto &glyph : atlas.glyphs)
+    {
+        glyph.u0 = static_cast<float>(glyph.rect.x) / GLYPH_ATLAS_WIDTH;
+        glyph.v0 = static_cast<float>(glyph.rect.y) / atlasHeight;
+        glyph.u1 = static_cast<float>(glyph.rect.x + glyph.rect.w) / GLYPH_ATLAS_WIDTH;
+        glyph.v1 = static_cast<float>(glyph.rect.y + glyph.rect.h) / atlasHeight;
+    }
+    return atlasSurface;
+}
+
+const GlyphAtlas *ResourceManager::getGlyphAtlas(FontHandle handle)
+{
+    if (!isLive(handle, fontSlots))
         return nullptr;
+
+    // Check if glyph atlas is already built
+    FontSlot &slot = fontSlots[handle.index];
+    if (slot.glyphAtlas.texture)
+        return &slot.glyphAtlas;
+
+    // Preloaded fonts come with their atlas already rasterised
+    if (!slot.glyphSurface)
+        slot.glyphSurface = rasteriseGlyphs(slot.font, slot.glyphAtlas);
+    if (slot.glyphSurface)
+    {
+        slot.glyphAtlas.texture = SDL_CreateTextureFromSurface(renderer, slot.glyphSurface);
+        retainSurfacePixels(slot.glyphAtlas.texture, slot.glyphSurface);
+        SDL_FreeSurface(slot.glyphSurface);
+        slot.glyphSurface = nullptr;
     }
 
-    fonts[key] = font;
-    return font;
+    if (!slot.glyphAtlas.texture)
+    {
+        std::cerr << "Failed to create glyph atlas for " << slot.path << " (" << slot.size << "): "
+                  << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(slot.glyphAtlas.texture, SDL_BLENDMODE_BLEND);
+    return &slot.glyphAtlas;
 }
 
-TTF_Font *ResourceManager::getFont(const std::string &path, int fontSize)
+void ResourceManager::destroyGlyphAtlas(GlyphAtlas &atlas)
 {
-    std::string key = getFontKey(path, fontSize);
-    auto it = fonts.find(key);
-    return it != fonts.end() ? it->second : nullptr;
+    if (atlas.texture)
+    {
+        destroyTexture(atlas.texture);
+        atlas.texture = nullptr;
+    }
+    atlas.font = nullptr;
 }
 
-void ResourceManager::unloadFont(const std::string &path, int fontSize)
+int GlyphAtlas::getKerning(char previous, char current) const
 {
-    std::string key = getFontKey(path, fontSize);
-    auto it = fonts.find(key);
-    if (it != fonts.end())
+    if (!font || previous == 0)
+        return 0;
+    return TTF_GetFontKerningSizeGlyphs(font, static_cast<unsigned char>(previous),
+                                        static_cast<unsigned char>(current));
+}
+
+int GlyphAtlas::measureText(const std::string &text) const
+{
+    int width = 0;
+    char previous = 0;
+    for (char c : text)
     {
-        TTF_CloseFont(it->second);
-        fonts.erase(it);
+        width += getKerning(previous, c) + getGlyph(c)->advance;
+        previous = c;
     }
+    return width;
 }
 
 SDL_Texture *ResourceManager::createTextTexture(const std::string &text, TTF_Font *font, SDL_Color color)
@@ -116,22 +1045,57 @@ SDL_Texture *ResourceManager::createTextTexture(const std::string &text, TTF_Fon
 
 void ResourceManager::cleanup()
 {
-    // Clean up textures
-    for (auto &[path, texture] : textures)
+    // Clip tables hold texture references, so the sprite atlas goes first
+    destroyAtlas();
+    for (auto &[texture, frame] : retiredTextures)
+    {
+        destroyTexture(texture);
+    }
+    retiredTextures.clear();
+
+    // Clean up textures, including requested ones; undecoded results are dropped
+    for (auto &slot : textureSlots)
+    {
+        if (slot.texture)
+            destroyTexture(slot.texture);
+    }
+    textureSlots.clear();
+    textureIndices.clear();
+    freeTextureSlots.clear();
+    textureStats.residentBytes = 0;
+    textureStats.residentTextures = 0;
+    for (auto &decoded : pendingUploads)
+    {
+        if (decoded.surface)
+            SDL_FreeSurface(decoded.surface);
+    }
+    pendingUploads.clear();
+
+    // Fonts the loader opened but nobody asked for
+    finishFontPreload();
+    for (auto &[key, loaded] : preloadedFonts)
     {
-        SDL_DestroyTexture(texture);
+        if (loaded.glyphSurface)
+            SDL_FreeSurface(loaded.glyphSurface);
+        TTF_CloseFont(loaded.font);
     }
-    textures.clear();
+    preloadedFonts.clear();
 
-    // Clean up fonts
-    for (auto &[key, font] : fonts)
+    // Clean up fonts and their glyph atlases (atlases first, they reference the fonts)
+    for (auto &slot : fontSlots)
     {
-        TTF_CloseFont(font);
+        destroyGlyphAtlas(slot.glyphAtlas);
+        if (slot.glyphSurface)
+            SDL_FreeSurface(slot.glyphSurface);
+        if (slot.font)
+            TTF_CloseFont(slot.font);
     }
-    fonts.clear();
+    fontSlots.clear();
+    fontIndices.clear();
+    freeFontSlots.clear();
 }
 
-std::string ResourceManager::getFontKey(const std::string &path, int fontSize)
+std::string ResourceManager::getFontKey(const std::string &path, int fontSize) const
 {
     return path + "_" + std::to_string(fontSize);
 }
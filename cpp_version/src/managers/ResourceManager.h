@@ -2,28 +2,259 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
+#include "AssetBundle.h"
+#include "AssetLoader.h"
+#include "ResourceHandles.h"
+#include <deque>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <thread>
+#include <vector>
+
+// Location of a single sprite frame inside a packed atlas page
+struct AtlasRegion {
+    SDL_Texture* texture;   // Atlas page the frame was packed into
+    SDL_Rect rect;          // Pixel rectangle of the frame within the page
+    float u0, v0, u1, v1;   // Normalized texture coordinates of rect
+    TextureHandle source;   // Standalone texture the frame draws whole (invalid for atlas pages)
+};
+
+// Animation clip for one (sprite type, direction): a run of frames in the clip frame table
+// plus how the frame is mirrored when moving against the sprite's facing
+struct SpriteClip {
+    int firstFrame = 0;
+    int frameCount = 0;
+    SDL_RendererFlip flipWhenNegative = SDL_FLIP_NONE; // Velocity < 0 along the clip's axis
+    SDL_RendererFlip flipWhenPositive = SDL_FLIP_NONE; // Velocity > 0 along the clip's axis
+};
+
+// One rasterised glyph inside a font's glyph atlas
+struct GlyphInfo {
+    SDL_Rect rect;          // Glyph cell within the atlas (full line height)
+    float u0, v0, u1, v1;   // Normalized texture coordinates of rect
+    int advance;            // Horizontal pen advance in pixels
+};
+
+// Printable ASCII glyph set of one (font, size) rasterised once in white;
+// text color is applied per vertex when drawing
+struct GlyphAtlas {
+    static constexpr int FIRST_CHAR = 32;  // ' '
+    static constexpr int LAST_CHAR = 126;  // '~'
+
+    SDL_Texture* texture = nullptr;
+    TTF_Font* font = nullptr;   // Kept for kerning lookups
+    int lineHeight = 0;
+    GlyphInfo glyphs[LAST_CHAR - FIRST_CHAR + 1] = {};
+
+    const GlyphInfo* getGlyph(char c) const {
+        int index = static_cast<unsigned char>(c);
+        if (index < FIRST_CHAR || index > LAST_CHAR)
+            index = '?';
+        return &glyphs[index - FIRST_CHAR];
+    }
+
+    int getKerning(char previous, char current) const;
+    int measureText(const std::string& text) const;
+};
+
+// Residency of the texture table (atlas pages and glyph atlases are pinned and not counted)
+struct TextureCacheStats {
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;     // 0 = unlimited
+    size_t residentTextures = 0;
+    Uint64 hits = 0;            // Draw lookups that found the texture resident
+    Uint64 misses = 0;          // Draw lookups of an evicted or still-streaming texture
+    Uint64 evictions = 0;
+};
+
+// CPU-side RGBA32 copy of a texture, kept for the software render backend
+struct TexturePixels {
+    int width = 0;
+    int height = 0;
+    std::vector<Uint32> pixels; // Tightly packed rows, SDL_PIXELFORMAT_RGBA32
+};
 
 class ResourceManager {
 private:
     SDL_Renderer* renderer;
-    std::unordered_map<std::string, SDL_Texture*> textures;
-    std::unordered_map<std::string, TTF_Font*> fonts;
+
+    // Texture table indexed by TextureHandle. Paths are only looked up when acquiring.
+    struct TextureSlot {
+        std::string path;
+        SDL_Texture* texture = nullptr; // nullptr while streaming in (or if loading failed)
+        int refCount = 0;               // 0 = free slot
+        int ticket = -1;                // Loader ticket while decoding asynchronously
+        bool failed = false;
+        bool evicted = false;           // Dropped for the budget; reloaded when used again
+        size_t bytes = 0;               // Memory held while resident (GPU copy plus retained pixels)
+        Uint64 lastUsedFrame = 0;
+    };
+    std::vector<TextureSlot> textureSlots;
+    std::unordered_map<std::string, int> textureIndices;
+    std::vector<int> freeTextureSlots;
+
+    // LRU budget over the texture table. Frames count processUploads() calls; textures
+    // drawn within the last EVICTION_MIN_AGE frames may still be referenced by a
+    // snapshot in the ring and are never evicted.
+    static constexpr Uint64 EVICTION_MIN_AGE = 4;
+    Uint64 currentFrame = 0;
+    TextureCacheStats textureStats;
+
+    // Font table indexed by FontHandle, one slot per (path, size)
+    struct FontSlot {
+        std::string path;
+        int size = 0;
+        TTF_Font* font = nullptr;
+        std::vector<Uint8> fileData;    // Font file the font reads from; SDL_ttf loads glyphs lazily
+        GlyphAtlas glyphAtlas;          // Rasterised on first use
+        SDL_Surface* glyphSurface = nullptr; // Atlas rasterised by the font loader, uploaded on first use
+        int refCount = 0;
+    };
+    std::vector<FontSlot> fontSlots;
+    std::unordered_map<std::string, int> fontIndices;
+    std::vector<int> freeFontSlots;
+
+    // Fonts opened and rasterised by the font loader thread; SDL_ttf belongs to
+    // that thread until finishFontPreload() joins it, then loadFont() adopts them
+    struct PreloadedFont {
+        TTF_Font* font = nullptr;
+        std::vector<Uint8> fileData;
+        GlyphAtlas glyphAtlas;
+        SDL_Surface* glyphSurface = nullptr;
+    };
+    std::thread fontLoader;
+    std::unordered_map<std::string, PreloadedFont> preloadedFonts; // By font key
+
+    // Pre-decoded assets; looked up before falling back to the loose files
+    const AssetBundle* bundle = nullptr;
+
+    // Background decoding; textures are created from the results in processUploads()
+    std::unique_ptr<AssetLoader> loader;
+    std::deque<AssetLoader::DecodedImage> pendingUploads;         // Decoded, waiting for the render thread
+    std::vector<std::pair<TextureHandle, int>> pendingClipFrames; // (texture, clip frame index)
+
+    // Pixel copies of textures, only populated when retainPixels is enabled
+    bool retainPixels = false;
+    std::unordered_map<SDL_Texture*, TexturePixels> texturePixels;
+
+    // Textures replaced after a device reset, destroyed once no snapshot in the
+    // ring can still reference them: (texture, frame it was retired on)
+    std::vector<std::pair<SDL_Texture*, Uint64>> retiredTextures;
+
+    // Sprite atlas pages and the frames packed into them
+    std::vector<SDL_Texture*> atlasPages;
+    std::unordered_map<std::string, AtlasRegion> atlasRegions;
+
+    // Animation clip tables resolved at load, indexed by (sprite type ID, direction, frame)
+    std::vector<std::string> spriteTypeNames;
+    std::vector<SpriteClip> spriteClips;
+    std::vector<AtlasRegion> clipFrames;
+    std::vector<TextureHandle> clipTextures; // Standalone frame textures held by the clip tables
+
+    static constexpr int ATLAS_PAGE_SIZE = 1024;
+    static constexpr int ATLAS_PADDING = 1; // Transparent gutter to avoid filtering bleed
+    static constexpr int GLYPH_ATLAS_WIDTH = 512;
 
 public:
-    ResourceManager(SDL_Renderer* renderer);
+    // loaderThreads: image decode workers (0 = one per hardware thread)
+    ResourceManager(SDL_Renderer* renderer, int loaderThreads = 0);
     ~ResourceManager();
     
-    // Texture management
-    SDL_Texture* loadTexture(const std::string& path);
-    SDL_Texture* getTexture(const std::string& path);
-    void unloadTexture(const std::string& path);
+    // Serve textures and fonts from a mapped bundle (nullptr = loose files only).
+    // The bundle must outlive every resource created from it.
+    void setBundle(const AssetBundle* assetBundle) { bundle = assetBundle; }
+
+    // Texture management. Loading a path returns a handle and adds a reference; the
+    // texture is destroyed when the last reference is released.
+    TextureHandle loadTexture(const std::string& path);
+    SDL_Texture* getTexture(TextureHandle handle) const {
+        return isLive(handle, textureSlots) ? textureSlots[handle.index].texture : nullptr;
+    }
+    void releaseTexture(TextureHandle handle);
+
+    // Texture lookup for drawing (snapshot thread): marks the texture used this frame and
+    // counts a hit, or a miss if it is not resident. An evicted texture that is used again
+    // is reloaded in the background by the next processUploads().
+    SDL_Texture* useTexture(TextureHandle handle) {
+        if (!isLive(handle, textureSlots))
+            return nullptr;
+        TextureSlot& slot = textureSlots[handle.index];
+        slot.lastUsedFrame = currentFrame;
+        if (slot.texture)
+            textureStats.hits++;
+        else
+            textureStats.misses++;
+        return slot.texture;
+    }
+
+    // Memory budget for the texture table in bytes (0 = unlimited); least recently
+    // used textures are evicted by processUploads() while the budget is exceeded
+    void setTextureBudget(size_t bytes) { textureStats.budgetBytes = bytes; }
+    const TextureCacheStats& getTextureStats() const { return textureStats; }
+
+    // Asynchronous texture loading: the handle is valid immediately and the texture
+    // appears once a worker has decoded it and processUploads() has created it
+    TextureHandle requestTexture(const std::string& path);
+    bool isTextureReady(TextureHandle handle) const { return getTexture(handle) != nullptr; }
+
+    // Once per frame: queue reloads of evicted textures that were used again, create
+    // textures for decoded images until budgetMs is spent (at least one per call), then
+    // evict down to the memory budget. Must run on the thread that owns the renderer
+    // while nothing reads clip tables.
+    int processUploads(float budgetMs);
+    size_t getPendingUploadCount() const;
+    int getLoaderThreadCount() const { return loader->getThreadCount(); }
+
+    // Keep CPU copies of texture pixels (needed by the software render backend).
+    // Must be enabled before any texture is loaded.
+    void setRetainPixels(bool retain) { retainPixels = retain; }
+    const TexturePixels* getTexturePixels(SDL_Texture* texture) const;
+
+    // The renderer lost every texture (SDL_RENDER_DEVICE_RESET): atlas pages are
+    // recreated from their retained pixels or decoded again, glyph atlases are
+    // rasterised again on next use and standalone textures reload when next drawn.
+    // Same threading rules as processUploads().
+    void recreateDeviceTextures();
+
+    // Sprite atlas management - packs every frame into as few pages as possible
+    bool buildSpriteAtlas(const std::vector<std::string>& paths);
+    const AtlasRegion* getAtlasRegion(const std::string& path) const;
+    size_t getAtlasPageCount() const { return atlasPages.size(); }
+
+    // Animation clip tables - built once after the atlas, looked up by index every frame
+    static constexpr int SPRITE_DIRECTIONS = 2; // Matches MovementDirection::Direction
+    int registerSpriteType(const std::string& name);
+    int getSpriteTypeId(const std::string& name) const;
+    bool setSpriteClip(int typeId, int direction, const std::vector<std::string>& framePaths,
+                       SDL_RendererFlip flipWhenNegative, SDL_RendererFlip flipWhenPositive);
+    const SpriteClip* getSpriteClip(int typeId, int direction) const {
+        if (typeId < 0 || typeId >= static_cast<int>(spriteTypeNames.size()) ||
+            direction < 0 || direction >= SPRITE_DIRECTIONS)
+            return nullptr;
+        const SpriteClip& clip = spriteClips[typeId * SPRITE_DIRECTIONS + direction];
+        return clip.frameCount > 0 ? &clip : nullptr;
+    }
+    const AtlasRegion& getClipFrame(const SpriteClip& clip, int frame) const {
+        return clipFrames[clip.firstFrame + frame];
+    }
     
-    // Font management
-    TTF_Font* loadFont(const std::string& path, int fontSize);
-    TTF_Font* getFont(const std::string& path, int fontSize);
-    void unloadFont(const std::string& path, int fontSize);
+    // Font management: one handle per (path, size), reference counted like textures
+    FontHandle loadFont(const std::string& path, int fontSize);
+    TTF_Font* getFont(FontHandle handle) const {
+        return isLive(handle, fontSlots) ? fontSlots[handle.index].font : nullptr;
+    }
+    void releaseFont(FontHandle handle);
+
+    // Open fonts and rasterise their glyph atlases on a thread of their own while
+    // other loading goes on; until finishFontPreload() returns, only that thread
+    // may call into SDL_ttf (loadFont() waits for it)
+    void startFontPreload(const std::vector<std::pair<std::string, int>>& fonts);
+    void finishFontPreload();
+
+    // Glyph atlas of a loaded font, rasterised on first use for quad-based text
+    // (must run on the thread that owns the renderer)
+    const GlyphAtlas* getGlyphAtlas(FontHandle handle);
     
     // Create text texture from font
     SDL_Texture* createTextTexture(const std::string& text, TTF_Font* font, SDL_Color color);
@@ -32,5 +263,30 @@ public:
     void cleanup();
 
 private:
-    std::string getFontKey(const std::string& path, int fontSize);
+    template <typename Handle, typename Slot>
+    static bool isLive(Handle handle, const std::vector<Slot>& slots) {
+        return handle.index >= 0 && handle.index < static_cast<int>(slots.size()) &&
+               slots[handle.index].refCount > 0;
+    }
+    template <typename Slot>
+    static int allocateSlot(std::vector<Slot>& slots, std::vector<int>& freeSlots);
+
+    std::string getFontKey(const std::string& path, int fontSize) const;
+    void preloadFonts(std::vector<std::pair<std::string, int>> fonts);
+    TTF_Font* openFont(const std::string& path, int fontSize, std::vector<Uint8>& fileData) const;
+    static SDL_Surface* rasteriseGlyphs(TTF_Font* font, GlyphAtlas& atlas);
+    void destroyAtlas();
+    void retainSurfacePixels(SDL_Texture* texture, SDL_Surface* surface);
+    void destroyTexture(SDL_Texture* texture);
+    SDL_Texture* decodeTexture(const std::string& path);
+    void finishTextureLoad(int index, SDL_Texture* texture);
+    void evictTexture(int index);
+    void dropResidentTexture(int index);
+    void retireTexture(SDL_Texture* texture);
+    SDL_Surface* createRetainedSurface(SDL_Texture* texture) const;
+    SDL_Surface* composeAtlasPage(SDL_Texture* page);
+    void enforceTextureBudget();
+    SDL_Texture* createTexture(SDL_Surface* rgba);
+    SDL_Surface* createBundledSurface(const std::string& path) const;
+    void destroyGlyphAtlas(GlyphAtlas& atlas);
 };
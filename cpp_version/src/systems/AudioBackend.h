@@ -0,0 +1,64 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+
+class MusicStreamer; // Forward declaration
+
+// Audio output selected with --audio
+enum class AudioOutput
+{
+    AUTO,    // Sound device, or the offline mixer when running headless
+    DEVICE,  // SDL_mixer on the system's sound device
+    NONE,    // Null device: commands are processed, nothing is decoded or mixed
+    OFFLINE  // Mixed in memory, one frame's worth of samples per game frame
+};
+
+// Output device under AudioSystem. AudioSystem decides which sound plays on
+// which voice; a backend makes it audible, mixes it into memory or drops it.
+// All calls come from the main thread.
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() = default;
+
+    // Open 16-bit stereo output; false if the device is unavailable
+    virtual bool open(int frequency, int chunkSize) = 0;
+    virtual void close() = 0;
+
+    // Whether sounds and music must be decoded (SDL_mixer must be open to load them)
+    virtual bool needsAudioData() const { return true; }
+
+    // Voices are numbered 0..count-1
+    virtual void allocateVoices(int count) = 0;
+    // volume 0-128; left/right 0-255 per-side gain
+    virtual bool startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right) = 0;
+    virtual void haltVoice(int voice) = 0; // -1 = all voices
+    virtual bool isVoicePlaying(int voice) const = 0;
+
+    // Music is streamed by AudioSystem; the backend pulls it while mixing (nullptr = none).
+    // False if the output format can't carry it.
+    virtual bool setMusicSource(MusicStreamer *source) = 0;
+
+    // Called once per frame with the frame's length (devices that pull samples themselves ignore it)
+    virtual void advance(float seconds) {}
+
+    virtual const char *getName() const = 0;
+};
+
+// Accepts everything and plays nothing, so the game runs without a sound device
+class NullAudioBackend : public AudioBackend
+{
+public:
+    bool open(int frequency, int chunkSize) override { return true; }
+    void close() override {}
+    bool needsAudioData() const override { return false; }
+
+    void allocateVoices(int count) override {}
+    bool startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right) override { return true; }
+    void haltVoice(int voice) override {}
+    bool isVoicePlaying(int voice) const override { return false; }
+
+    bool setMusicSource(MusicStreamer *source) override { return true; }
+
+    const char *getName() const override { return "null"; }
+};
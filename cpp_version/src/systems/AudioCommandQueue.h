@@ -0,0 +1,67 @@
+#pragma once
+#include "../managers/ResourceHandles.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstddef>
+
+// One request from gameplay code to the audio stage
+struct AudioCommand
+{
+    enum Type : Uint8
+    {
+        PLAY_SOUND,
+        PLAY_MUSIC,
+        STOP_MUSIC
+    };
+
+    Type type = PLAY_SOUND;
+    Uint8 volume = 128;  // 0-128, scaled by the SFX volume
+    Uint8 priority = 0;  // Higher wins when voices are scarce
+    bool loop = true;    // PLAY_MUSIC
+    float pan = 0.0f;    // -1 = left, 0 = centre, 1 = right
+    SoundHandle sound;   // PLAY_SOUND
+    MusicHandle music;   // PLAY_MUSIC
+    Uint64 issuedAt = 0; // SDL_GetPerformanceCounter() when queued, for latency stats
+};
+
+// Fixed-size single-producer/single-consumer ring of audio commands. The
+// simulation pushes, the audio stage drains once per frame; neither side
+// locks or waits. A full queue drops the command rather than blocking.
+class AudioCommandQueue
+{
+public:
+    static constexpr size_t CAPACITY = 256; // Power of two
+
+private:
+    AudioCommand commands[CAPACITY];
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to read (consumer)
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to write (producer)
+    size_t dropped = 0;                      // Producer side only
+
+public:
+    // Producer side
+    bool push(const AudioCommand &command)
+    {
+        size_t writeIndex = tail.load(std::memory_order_relaxed);
+        if (writeIndex - head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            dropped++;
+            return false;
+        }
+        commands[writeIndex & (CAPACITY - 1)] = command;
+        tail.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+    size_t getDroppedCount() const { return dropped; }
+
+    // Consumer side
+    bool pop(AudioCommand &command)
+    {
+        size_t readIndex = head.load(std::memory_order_relaxed);
+        if (readIndex == tail.load(std::memory_order_acquire))
+            return false;
+        command = commands[readIndex & (CAPACITY - 1)];
+        head.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+};
@@ -1,7 +1,9 @@
 #include "AudioSystem.h"
+#include "../managers/AssetLoader.h"
+#include <algorithm>
 #include <iostream>
 
-AudioSystem::AudioSystem() {}
+AudioSystem::AudioSystem(std::unique_ptr<AudioBackend> output) : backend(std::move(output)) {}
 
 AudioSystem::~AudioSystem()
 {
@@ -10,41 +12,129 @@ AudioSystem::~AudioSystem()
 
 bool AudioSystem::initialize()
 {
-    // Initialize SDL_mixer
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
+    // Machines without a sound device still run the game, silently
+    if (!backend->open(OUTPUT_FREQUENCY, OUTPUT_CHUNK_SIZE))
     {
-        std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
-        return false;
+        if (dynamic_cast<NullAudioBackend *>(backend.get()))
+            return false;
+        std::cerr << "Audio backend '" << backend->getName() << "' unavailable, continuing without sound" << std::endl;
+        backend = std::make_unique<NullAudioBackend>();
+        backend->open(OUTPUT_FREQUENCY, OUTPUT_CHUNK_SIZE);
+    }
+
+    setVoiceCount(DEFAULT_VOICE_COUNT);
+
+    // Music is decoded on the streamer's thread at the rate the device was opened with
+    if (backend->needsAudioData())
+    {
+        int frequency = 0, channels = 0;
+        Uint16 format = 0;
+        Mix_QuerySpec(&frequency, &format, &channels);
+        musicStreamer = std::make_unique<MusicStreamer>(frequency);
+        if (!backend->setMusicSource(musicStreamer.get()))
+        {
+            std::cerr << "Music disabled on the '" << backend->getName() << "' backend" << std::endl;
+            musicStreamer.reset();
+        }
     }
 
     // Set initial volumes
-    Mix_VolumeMusic(musicVolume);
-    Mix_Volume(-1, sfxVolume); // -1 sets volume for all channels
+    setMusicVolume(musicVolume);
 
     return true;
 }
 
-bool AudioSystem::loadSoundEffect(const std::string &name, const std::string &filePath)
+void AudioSystem::setVoiceCount(int count)
+{
+    count = std::max(1, std::min(256, count));
+    backend->allocateVoices(count);
+    voices.assign(count, Voice());
+}
+
+SoundHandle AudioSystem::loadSoundEffect(const std::string &name, const std::string &filePath,
+                                         int maxVoices, Uint8 priority)
 {
     // Construct full path to asset
     std::string fullPath = std::string(ASSET_PATH) + filePath;
 
-    Mix_Chunk *sound = Mix_LoadWAV(fullPath.c_str());
-    if (!sound)
+    // The null device plays nothing, so only the name is registered
+    bool decode = backend->needsAudioData();
+    Mix_Chunk *sound = decode ? loadBundledSoundEffect(filePath) : nullptr;
+    std::vector<Uint8> fileData;
+    if (decode && !sound && AssetLoader::readFile(filePath, fileData))
+    {
+        // Mix_LoadWAV_RW decodes the whole file up front, the bytes can go afterwards
+        sound = Mix_LoadWAV_RW(SDL_RWFromConstMem(fileData.data(), static_cast<int>(fileData.size())), 1);
+    }
+    if (decode && !sound)
     {
         std::cerr << "Failed to load sound effect '" << name << "' from '" << fullPath << "': " << Mix_GetError() << std::endl;
-        return false;
+        return SoundHandle();
     }
 
-    // Free existing sound if it exists
-    auto it = soundEffects.find(name);
-    if (it != soundEffects.end())
+    // Free existing sound if it exists; its handle stays valid
+    SoundHandle handle = findSound(name);
+    if (handle.isValid())
     {
-        Mix_FreeChunk(it->second);
+        SoundSlot &slot = sounds[handle.index];
+        if (slot.chunk)
+            Mix_FreeChunk(slot.chunk);
+        slot.chunk = sound;
+        slot.refCount++;
+        slot.maxVoices = std::max(1, maxVoices);
+        slot.priority = priority;
+        return handle;
     }
 
-    soundEffects[name] = sound;
-    return true;
+    if (!freeSoundSlots.empty())
+    {
+        handle.index = freeSoundSlots.back();
+        freeSoundSlots.pop_back();
+    }
+    else
+    {
+        handle.index = static_cast<int>(sounds.size());
+        sounds.emplace_back();
+    }
+    SoundSlot &slot = sounds[handle.index];
+    slot = SoundSlot();
+    slot.name = name;
+    slot.chunk = sound;
+    slot.refCount = 1;
+    slot.maxVoices = std::max(1, maxVoices);
+    slot.priority = priority;
+    soundIndices[name] = handle.index;
+    return handle;
+}
+
+void AudioSystem::releaseSound(SoundHandle sound)
+{
+    if (!sound.isValid() || sound.index >= static_cast<int>(sounds.size()) || sounds[sound.index].refCount == 0)
+        return;
+
+    SoundSlot &slot = sounds[sound.index];
+    if (--slot.refCount > 0)
+        return;
+
+    for (int channel = 0; channel < static_cast<int>(voices.size()); ++channel)
+    {
+        if (voices[channel].sound == sound)
+        {
+            backend->haltVoice(channel);
+            voices[channel] = Voice();
+        }
+    }
+    if (slot.chunk)
+        Mix_FreeChunk(slot.chunk);
+    soundIndices.erase(slot.name);
+    slot = SoundSlot();
+    freeSoundSlots.push_back(sound.index);
+}
+
+SoundHandle AudioSystem::findSound(const std::string &name) const
+{
+    auto it = soundIndices.find(name);
+    return it != soundIndices.end() ? SoundHandle{it->second} : SoundHandle();
 }
 
 bool AudioSystem::loadMusic(const std::string &name, const std::string &filePath)
@@ -52,158 +142,358 @@ bool AudioSystem::loadMusic(const std::string &name, const std::string &filePath
     // Construct full path to asset
     std::string fullPath = std::string(ASSET_PATH) + filePath;
 
-    Mix_Music *music = Mix_LoadMUS(fullPath.c_str());
-    if (!music)
+    // Music is decoded while it plays, so a bundled copy is streamed from the mapping
+    MusicSource source;
+    source.path = fullPath;
+    source.bundled = bundle ? bundle->find(filePath, AssetBundle::BLOB) : nullptr;
+    if (musicStreamer && !MusicStreamer::probe(source))
     {
-        std::cerr << "Failed to load music '" << name << "' from '" << fullPath << "': " << Mix_GetError() << std::endl;
+        std::cerr << "Failed to load music '" << name << "' from '" << fullPath << "'" << std::endl;
         return false;
     }
 
-    // Free existing music if it exists
-    auto it = backgroundMusic.find(name);
-    if (it != backgroundMusic.end())
+    // Replace existing music if it exists; its handle stays valid and a playing copy finishes
+    MusicHandle handle = findMusic(name);
+    if (handle.isValid())
     {
-        Mix_FreeMusic(it->second);
+        musicTracks[handle.index] = source;
+        return true;
     }
 
-    backgroundMusic[name] = music;
+    musicIndices[name] = static_cast<int>(musicTracks.size());
+    musicTracks.push_back(source);
     return true;
 }
 
-void AudioSystem::playSound(const std::string &name)
+MusicHandle AudioSystem::findMusic(const std::string &name) const
 {
-    auto it = soundEffects.find(name);
-    if (it != soundEffects.end())
-    {
-        Mix_PlayChannel(-1, it->second, 0); // -1 = first available channel, 0 = play once
-    }
-    else
+    auto it = musicIndices.find(name);
+    return it != musicIndices.end() ? MusicHandle{it->second} : MusicHandle();
+}
+
+Mix_Chunk *AudioSystem::loadBundledSoundEffect(const std::string &filePath)
+{
+    if (!bundle)
+        return nullptr;
+
+    // PCM in the mixer's output format is used in place without conversion
+    if (const AssetBundle::Entry *pcm = bundle->find(filePath, AssetBundle::PCM))
     {
-        std::cerr << "Sound effect '" << name << "' not found!" << std::endl;
+        int frequency = 0, channels = 0;
+        Uint16 format = 0;
+        Mix_QuerySpec(&frequency, &format, &channels);
+        if (pcm->frequency == frequency && pcm->format == format && pcm->channels == channels)
+        {
+            // Mix_QuickLoad_RAW borrows the buffer and never writes to it
+            return Mix_QuickLoad_RAW(const_cast<Uint8 *>(pcm->data), static_cast<Uint32>(pcm->size));
+        }
+        std::cerr << "Bundled sound '" << filePath << "' does not match the mixer format, loading the file instead"
+                  << std::endl;
+        return nullptr;
     }
+
+    if (const AssetBundle::Entry *blob = bundle->find(filePath, AssetBundle::BLOB))
+        return Mix_LoadWAV_RW(AssetBundle::openStream(*blob), 1);
+    return nullptr;
+}
+
+void AudioSystem::playSound(SoundHandle sound, Uint8 volume, float pan, Uint8 priority)
+{
+    AudioCommand command;
+    command.type = AudioCommand::PLAY_SOUND;
+    command.sound = sound;
+    command.volume = volume;
+    command.pan = pan;
+    command.priority = priority;
+    command.issuedAt = SDL_GetPerformanceCounter();
+    commands.push(command);
+}
+
+void AudioSystem::playMusic(MusicHandle track, bool loop)
+{
+    AudioCommand command;
+    command.type = AudioCommand::PLAY_MUSIC;
+    command.music = track;
+    command.loop = loop;
+    command.issuedAt = SDL_GetPerformanceCounter();
+    commands.push(command);
+}
+
+void AudioSystem::stopMusic()
+{
+    AudioCommand command;
+    command.type = AudioCommand::STOP_MUSIC;
+    command.issuedAt = SDL_GetPerformanceCounter();
+    commands.push(command);
 }
 
-void AudioSystem::playMusic(const std::string &name, bool loop)
+void AudioSystem::processCommands()
 {
-    auto it = backgroundMusic.find(name);
-    if (it != backgroundMusic.end())
+    // A track that found every streamer slot busy fading tries again
+    if (hasPendingMusic)
+    {
+        hasPendingMusic = false;
+        startMusic(pendingMusic);
+    }
+
+    AudioCommand command;
+    while (commands.pop(command))
     {
-        // Stop current music if playing
-        if (musicPlaying)
+        switch (command.type)
         {
-            Mix_HaltMusic();
+        case AudioCommand::PLAY_SOUND:
+            queueSound(command);
+            break;
+        case AudioCommand::PLAY_MUSIC:
+            startMusic(command);
+            break;
+        case AudioCommand::STOP_MUSIC:
+            haltMusic();
+            break;
         }
+    }
+
+    if (frameSounds.empty())
+        return;
 
-        // Play new music
-        int loops = loop ? -1 : 0; // -1 = infinite loop, 0 = play once
-        if (Mix_PlayMusic(it->second, loops) == 0)
+    // Free the voices whose sounds have ended
+    for (size_t channel = 0; channel < voices.size(); ++channel)
+    {
+        if (voices[channel].sound.isValid() && !backend->isVoicePlaying(static_cast<int>(channel)))
+            voices[channel] = Voice();
+    }
+
+    // Highest priority first, so when voices run out it is the least important that miss out
+    std::stable_sort(frameSounds.begin(), frameSounds.end(),
+                     [](const AudioCommand &a, const AudioCommand &b) { return a.priority > b.priority; });
+    for (const AudioCommand &sound : frameSounds)
+    {
+        sounds[sound.sound.index].frameSound = -1;
+        startSound(sound);
+    }
+    frameSounds.clear();
+}
+
+void AudioSystem::queueSound(const AudioCommand &command)
+{
+    SoundHandle sound = command.sound;
+    if (!sound.isValid() || sound.index >= static_cast<int>(sounds.size()) || sounds[sound.index].refCount == 0)
+    {
+        std::cerr << "Sound effect handle " << sound.index << " not loaded!" << std::endl;
+        return;
+    }
+
+    SoundSlot &slot = sounds[sound.index];
+    Uint8 priority = std::max(command.priority, slot.priority);
+    if (slot.frameSound < 0)
+    {
+        slot.frameSound = static_cast<int>(frameSounds.size());
+        frameSounds.push_back(command);
+        frameSounds.back().priority = priority;
+        return;
+    }
+
+    // Already playing this frame: stacking identical sounds only makes them louder
+    AudioCommand &merged = frameSounds[slot.frameSound];
+    if (command.volume > merged.volume)
+    {
+        merged.volume = command.volume;
+        merged.pan = command.pan;
+    }
+    merged.priority = std::max(merged.priority, priority);
+    merged.issuedAt = std::min(merged.issuedAt, command.issuedAt);
+    voiceStats.coalesced++;
+}
+
+int AudioSystem::chooseVoice(const AudioCommand &command) const
+{
+    int freeVoice = -1, oldestInstance = -1, instances = 0, weakest = -1;
+    for (int channel = 0; channel < static_cast<int>(voices.size()); ++channel)
+    {
+        const Voice &voice = voices[channel];
+        if (!voice.sound.isValid())
         {
-            currentMusic = it->second;
-            musicPlaying = true;
+            if (freeVoice < 0)
+                freeVoice = channel;
+            continue;
         }
-        else
+        if (voice.sound == command.sound)
         {
-            std::cerr << "Failed to play music '" << name << "': " << Mix_GetError() << std::endl;
+            instances++;
+            if (oldestInstance < 0 || voice.startOrder < voices[oldestInstance].startOrder)
+                oldestInstance = channel;
         }
+        if (weakest < 0 || voice.priority < voices[weakest].priority ||
+            (voice.priority == voices[weakest].priority && voice.startOrder < voices[weakest].startOrder))
+            weakest = channel;
     }
-    else
+
+    // At the sound's cap the new instance replaces its own oldest one
+    if (instances >= sounds[command.sound.index].maxVoices)
+        return oldestInstance;
+    if (freeVoice >= 0)
+        return freeVoice;
+    if (weakest >= 0 && voices[weakest].priority <= command.priority)
+        return weakest;
+    return -1;
+}
+
+void AudioSystem::startSound(const AudioCommand &command)
+{
+    int channel = chooseVoice(command);
+    if (channel < 0)
+    {
+        voiceStats.dropped++;
+        return;
+    }
+    if (voices[channel].sound.isValid())
+    {
+        backend->haltVoice(channel);
+        voiceStats.stolen++;
+    }
+
+    float pan = std::max(-1.0f, std::min(1.0f, command.pan));
+    Uint8 left = static_cast<Uint8>(255 * std::min(1.0f, 1.0f - pan));
+    Uint8 right = static_cast<Uint8>(255 * std::min(1.0f, 1.0f + pan));
+    int volume = command.volume * sfxVolume / MIX_MAX_VOLUME;
+    if (!backend->startVoice(channel, sounds[command.sound.index].chunk, volume, left, right))
     {
-        std::cerr << "Music '" << name << "' not found!" << std::endl;
+        voices[channel] = Voice();
+        voiceStats.dropped++;
+        return;
     }
+    voices[channel] = {command.sound, command.priority, nextStartOrder++};
+    voiceStats.played++;
+
+    double latencyMs = static_cast<double>(SDL_GetPerformanceCounter() - command.issuedAt) * 1000.0 /
+                       static_cast<double>(SDL_GetPerformanceFrequency());
+    voiceStats.totalLatencyMs += latencyMs;
+    voiceStats.maxLatencyMs = std::max(voiceStats.maxLatencyMs, latencyMs);
 }
 
-void AudioSystem::stopMusic()
+void AudioSystem::startMusic(const AudioCommand &command)
+{
+    MusicHandle track = command.music;
+    if (!track.isValid() || track.index >= static_cast<int>(musicTracks.size()))
+    {
+        std::cerr << "Music handle " << track.index << " not loaded!" << std::endl;
+        return;
+    }
+
+    // The streamer fades the current track out while the new one fades in
+    if (musicStreamer && !musicStreamer->play(musicTracks[track.index], command.loop, crossfadeSeconds))
+    {
+        pendingMusic = command;
+        hasPendingMusic = true;
+        return;
+    }
+    currentMusic = track;
+    musicPlaying = true;
+}
+
+void AudioSystem::haltMusic()
 {
+    hasPendingMusic = false;
     if (musicPlaying)
     {
-        Mix_HaltMusic();
+        if (musicStreamer)
+            musicStreamer->stop(crossfadeSeconds);
         musicPlaying = false;
-        currentMusic = nullptr;
+        currentMusic = MusicHandle();
     }
 }
 
 void AudioSystem::pauseMusic()
 {
-    if (musicPlaying)
+    if (musicPlaying && musicStreamer)
     {
-        Mix_PauseMusic();
+        musicStreamer->setPaused(true);
     }
 }
 
 void AudioSystem::resumeMusic()
 {
-    if (musicPlaying && Mix_PausedMusic())
+    if (musicPlaying && musicStreamer && musicStreamer->isPaused())
     {
-        Mix_ResumeMusic();
+        musicStreamer->setPaused(false);
     }
 }
 
 void AudioSystem::setMusicVolume(int volume)
 {
     musicVolume = std::max(0, std::min(128, volume));
-    Mix_VolumeMusic(musicVolume);
+    if (musicStreamer)
+        musicStreamer->setVolume(musicVolume);
 }
 
 void AudioSystem::setSFXVolume(int volume)
 {
+    // Applied per play on top of each sound's own volume
     sfxVolume = std::max(0, std::min(128, volume));
-    Mix_Volume(-1, sfxVolume);
 }
 
 void AudioSystem::update(ECS &ecs, GameManager &gameManager, float deltaTime)
 {
-    static GameManager::GameState lastState = GameManager::MENU;
-
-    // Handle music changes based on game state
-    if (gameManager.currentState != lastState)
-    {
-        handleGameStateMusic(gameManager.currentState);
-        lastState = gameManager.currentState;
-    }
+    // Queue a music change whenever the state's track differs from the last one asked for
+    // (this also starts the menu track on the first tick)
+    handleGameStateMusic(gameManager.currentState);
 }
 
 void AudioSystem::handleGameStateMusic(GameManager::GameState state)
 {
-    switch (state)
-    {
-    case GameManager::MENU:
-        // Play menu music or stop music
-        stopMusic();
-        break;
-
-    case GameManager::PLAYING:
-        // Play background music during gameplay
-        playMusic("background", true);
-        break;
+    // Each state has its own track (or silence); the streamer crossfades between them.
+    // The game over sound itself is queued by the collision that ended the game.
+    MusicHandle track = stateMusic[state];
+    if (track == requestedMusic)
+        return;
 
-    case GameManager::GAME_OVER:
-        // Stop background music and play game over sound
+    if (track.isValid())
+        playMusic(track, true);
+    else
         stopMusic();
-        playSound("gameover");
-        break;
-    }
+    requestedMusic = track;
+}
+
+bool AudioSystem::parseAudioOutput(const std::string &name, AudioOutput &output)
+{
+    if (name == "device")
+        output = AudioOutput::DEVICE;
+    else if (name == "null")
+        output = AudioOutput::NONE;
+    else if (name == "offline")
+        output = AudioOutput::OFFLINE;
+    else
+        return false;
+    return true;
 }
 
 void AudioSystem::cleanup()
 {
-    // Stop all audio
-    Mix_HaltMusic();
-    Mix_HaltChannel(-1);
+    // Stop all audio; the backend stops pulling music before the streamer goes away
+    backend->setMusicSource(nullptr);
+    musicStreamer.reset();
+    backend->haltVoice(-1);
 
     // Free sound effects
-    for (auto &[name, sound] : soundEffects)
+    for (auto &slot : sounds)
     {
-        Mix_FreeChunk(sound);
+        if (slot.chunk)
+            Mix_FreeChunk(slot.chunk);
     }
-    soundEffects.clear();
+    sounds.clear();
+    soundIndices.clear();
+    freeSoundSlots.clear();
+    frameSounds.clear();
+    for (Voice &voice : voices)
+        voice = Voice();
 
-    // Free music
-    for (auto &[name, music] : backgroundMusic)
-    {
-        Mix_FreeMusic(music);
-    }
-    backgroundMusic.clear();
+    // Forget music
+    musicTracks.clear();
+    musicIndices.clear();
+    currentMusic = MusicHandle();
+    musicPlaying = false;
+    hasPendingMusic = false;
 
-    // Close SDL_mixer
-    Mix_CloseAudio();
+    // Close the output device
+    backend->close();
 }
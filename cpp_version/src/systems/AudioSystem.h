@@ -1,38 +1,138 @@
 #pragma once
 #include "System.h"
 #include "../managers/GameManager.h"
+#include "../managers/AssetBundle.h"
+#include "../managers/ResourceHandles.h"
+#include "AudioBackend.h"
+#include "AudioCommandQueue.h"
+#include "MusicStreamer.h"
 #include <SDL2/SDL_mixer.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
+
+// Sound effect playback counters since startup
+struct AudioVoiceStats
+{
+    size_t played = 0;    // Sounds started on a voice
+    size_t coalesced = 0; // Repeats of a sound already started this frame, merged into it
+    size_t stolen = 0;    // Voices cut off for a sound of equal or higher priority
+    size_t dropped = 0;   // Sounds not played because every voice had higher priority
+    double totalLatencyMs = 0.0; // playSound() to the voice starting, summed over played sounds
+    double maxLatencyMs = 0.0;
+};
 
 class AudioSystem : public System
 {
+public:
+    static constexpr int DEFAULT_VOICE_COUNT = 16;
+    static constexpr int DEFAULT_MAX_VOICES_PER_SOUND = 4;
+    static constexpr int OUTPUT_FREQUENCY = 44100;
+    static constexpr int OUTPUT_CHUNK_SIZE = 2048;
+
 private:
-    std::unordered_map<std::string, Mix_Chunk *> soundEffects;
-    std::unordered_map<std::string, Mix_Music *> backgroundMusic;
+    std::unique_ptr<AudioBackend> backend;
+
+    // Sound table indexed by SoundHandle; names are only looked up when resolving
+    struct SoundSlot
+    {
+        std::string name;
+        Mix_Chunk *chunk = nullptr; // nullptr when the backend needs no audio data
+        int refCount = 0; // 0 = free slot
+        int maxVoices = DEFAULT_MAX_VOICES_PER_SOUND; // Concurrent instances of this sound
+        Uint8 priority = 0;                           // Floor for commands playing it
+        int frameSound = -1;                          // Index into frameSounds while draining
+    };
+    std::vector<SoundSlot> sounds;
+    std::unordered_map<std::string, int> soundIndices;
+    std::vector<int> freeSoundSlots;
+
+    // Music table indexed by MusicHandle; tracks are streamed, never loaded whole
+    std::vector<MusicSource> musicTracks;
+    std::unordered_map<std::string, int> musicIndices;
+    std::unique_ptr<MusicStreamer> musicStreamer; // nullptr when the backend plays no audio
+    float crossfadeSeconds = 1.0f;
+
+    // Track per game state (invalid = silence); read by the simulation in update()
+    MusicHandle stateMusic[3];
+    MusicHandle requestedMusic; // Simulation side: last track asked for
+
+    // Commands pushed by the simulation, played by processCommands() on the main thread
+    AudioCommandQueue commands;
+    std::vector<AudioCommand> frameSounds; // This frame's sound commands, one per sound
 
-    Mix_Music *currentMusic = nullptr;
+    // Fixed voice pool, one entry per mixer channel
+    struct Voice
+    {
+        SoundHandle sound; // Invalid = free
+        Uint8 priority = 0;
+        Uint32 startOrder = 0; // Lower = started earlier
+    };
+    std::vector<Voice> voices;
+    Uint32 nextStartOrder = 0;
+    AudioVoiceStats voiceStats;
+
+    // Pre-decoded sounds and music file bytes; chunks may point into its mapping
+    const AssetBundle *bundle = nullptr;
+
+    MusicHandle currentMusic;
     bool musicPlaying = false;
+    AudioCommand pendingMusic; // PLAY_MUSIC waiting for a streamer slot to finish fading
+    bool hasPendingMusic = false;
 
     // Volume settings (0-128)
     int musicVolume = 64;
     int sfxVolume = 64;
 
 public:
-    AudioSystem();
+    explicit AudioSystem(std::unique_ptr<AudioBackend> output);
     ~AudioSystem();
 
-    // Initialize SDL_mixer
+    // Open the backend; if the sound device can't be opened, continue on the null device
     bool initialize();
+    AudioBackend *getBackend() const { return backend.get(); }
+
+    // Load audio from a mapped bundle when it has the file (must outlive the loaded audio)
+    void setBundle(const AssetBundle *assetBundle) { bundle = assetBundle; }
+
+    // Size of the voice pool (mixer channels); all sound effects share it
+    void setVoiceCount(int count);
 
     // Load audio assets
-    bool loadSoundEffect(const std::string &name, const std::string &filePath);
+    // Loading a sound adds a reference to its handle (reloading a name replaces the
+    // chunk in place); the chunk is freed when the last reference is released
+    SoundHandle loadSoundEffect(const std::string &name, const std::string &filePath,
+                                int maxVoices = DEFAULT_MAX_VOICES_PER_SOUND, Uint8 priority = 0);
+    void releaseSound(SoundHandle sound);
+    SoundHandle findSound(const std::string &name) const; // Invalid if not loaded
+    // Music only checks that the file decodes; playback streams it (Ogg Vorbis)
     bool loadMusic(const std::string &name, const std::string &filePath);
+    MusicHandle findMusic(const std::string &name) const; // Invalid if not loaded
 
-    // Play audio
-    void playSound(const std::string &name);
-    void playMusic(const std::string &name, bool loop = true);
+    // Music for each game state, crossfaded on state changes (set before the game loop starts)
+    void setStateMusic(GameManager::GameState state, MusicHandle track) { stateMusic[state] = track; }
+    void setCrossfadeTime(float seconds) { crossfadeSeconds = std::max(0.0f, seconds); }
+    size_t getMusicBufferBytes() const { return musicStreamer ? musicStreamer->getBufferBytes() : 0; }
+
+    // Queue audio from gameplay code; nothing touches the mixer until processCommands()
+    // volume is 0-128 (scaled by the SFX volume), pan is -1 (left) to 1 (right)
+    void playSound(SoundHandle sound, Uint8 volume = MIX_MAX_VOLUME, float pan = 0.0f, Uint8 priority = 0);
+    void playMusic(MusicHandle track, bool loop = true);
     void stopMusic();
+
+    // Audio stage: run the queued commands against the mixer, once per frame
+    // Repeats of a sound within one frame play once, at the loudest volume and highest
+    // priority requested; more sounds than voices steal the lowest priority, oldest voice
+    void processCommands();
+    // Let the backend mix this frame's output (offline device)
+    void advance(float seconds) { backend->advance(seconds); }
+    size_t getDroppedCommandCount() const { return commands.getDroppedCount(); }
+    const AudioVoiceStats &getVoiceStats() const { return voiceStats; }
+
+    // Immediate music control (main thread only)
     void pauseMusic();
     void resumeMusic();
 
@@ -46,6 +146,14 @@ public:
     // Cleanup
     void cleanup();
 
+    static bool parseAudioOutput(const std::string &name, AudioOutput &output);
+
 private:
     void handleGameStateMusic(GameManager::GameState state);
+    Mix_Chunk *loadBundledSoundEffect(const std::string &filePath);
+    void queueSound(const AudioCommand &command);
+    void startSound(const AudioCommand &command);
+    int chooseVoice(const AudioCommand &command) const;
+    void startMusic(const AudioCommand &command);
+    void haltMusic();
 };
@@ -7,10 +7,10 @@ void BoundarySystem::update(ECS &ecs, GameManager &gameManager, float deltaTime)
     // Always keep player in bounds
     keepPlayerInBounds(ecs);
 
-    // Remove off-screen mobs during gameplay
+    // Remove mobs that left the world during gameplay
     if (gameManager.currentState == GameManager::PLAYING)
     {
-        removeOffScreenMobs(ecs);
+        removeOutOfWorldMobs(ecs);
     }
 }
 
@@ -30,32 +30,35 @@ void BoundarySystem::keepPlayerInBounds(ECS &ecs)
         float halfWidth = sprite->width / 2.0f;
         float halfHeight = sprite->height / 2.0f;
 
-        // Clamp position to screen bounds
+        // Clamp position to world bounds
         if (transform->x - halfWidth < 0)
         {
             transform->x = halfWidth;
         }
-        else if (transform->x + halfWidth > screenWidth)
+        else if (transform->x + halfWidth > worldWidth)
         {
-            transform->x = screenWidth - halfWidth;
+            transform->x = worldWidth - halfWidth;
         }
 
         if (transform->y - halfHeight < 0)
         {
             transform->y = halfHeight;
         }
-        else if (transform->y + halfHeight > screenHeight)
+        else if (transform->y + halfHeight > worldHeight)
         {
-            transform->y = screenHeight - halfHeight;
+            transform->y = worldHeight - halfHeight;
         }
     }
 }
 
-void BoundarySystem::removeOffScreenMobs(ECS &ecs)
+void BoundarySystem::removeOutOfWorldMobs(ECS &ecs)
 {
     auto &mobTags = ecs.getComponents<MobTag>();
     std::vector<EntityID> mobsToRemove;
 
+    // Mobs spawn just outside the view, so leave a margin before removing them
+    const float margin = 100.0f;
+
     for (auto &[entityID, mobTag] : mobTags)
     {
         auto *transform = ecs.getComponent<Transform>(entityID);
@@ -64,18 +67,20 @@ void BoundarySystem::removeOffScreenMobs(ECS &ecs)
         if (!transform || !sprite)
             continue;
 
-        // Check if mob is completely off-screen to the left
-        float rightEdge = transform->x + sprite->width / 2.0f;
-        if (rightEdge < -50.0f) // Give some buffer
+        // Check if mob is completely outside the world on any side
+        float halfWidth = sprite->width / 2.0f;
+        float halfHeight = sprite->height / 2.0f;
+        if (transform->x + halfWidth < -margin || transform->x - halfWidth > worldWidth + margin ||
+            transform->y + halfHeight < -margin || transform->y - halfHeight > worldHeight + margin)
         {
             mobsToRemove.push_back(entityID);
         }
     }
 
-    // Remove off-screen mobs
+    // Remove mobs that left the world
     for (EntityID mobID : mobsToRemove)
     {
-        std::cout << "Removing off-screen mob: " << mobID << std::endl;
+        std::cout << "Removing out-of-world mob: " << mobID << std::endl;
         ecs.removeEntity(mobID);
     }
 }
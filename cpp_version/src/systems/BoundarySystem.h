@@ -6,16 +6,16 @@
 class BoundarySystem : public System
 {
 private:
-    float screenWidth;
-    float screenHeight;
+    float worldWidth;
+    float worldHeight;
 
 public:
-    BoundarySystem(float screenW, float screenH)
-        : screenWidth(screenW), screenHeight(screenH) {}
+    BoundarySystem(float worldW, float worldH)
+        : worldWidth(worldW), worldHeight(worldH) {}
 
     void update(ECS &ecs, GameManager &gameManager, float deltaTime) override;
 
 private:
     void keepPlayerInBounds(ECS &ecs);
-    void removeOffScreenMobs(ECS &ecs);
+    void removeOutOfWorldMobs(ECS &ecs);
 };
@@ -0,0 +1,428 @@
+#include "CPURenderBackend.h"
+#include "../managers/ResourceManager.h"
+#include "../core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_BACKEND_SSE2 1
+#endif
+
+namespace
+{
+    // Exact x / 255 for x in [0, 255 * 255]
+    inline unsigned div255(unsigned x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    // Source-over blend of one RGBA32 texel onto the destination
+    inline Uint32 blendPixel(Uint32 src, Uint32 dst)
+    {
+        Uint8 s[4], d[4], out[4];
+        std::memcpy(s, &src, 4);
+        unsigned alpha = s[3];
+        if (alpha == 255)
+            return src;
+        if (alpha == 0)
+            return dst;
+
+        std::memcpy(d, &dst, 4);
+        unsigned inverse = 255 - alpha;
+        out[0] = static_cast<Uint8>(div255(s[0] * alpha + d[0] * inverse));
+        out[1] = static_cast<Uint8>(div255(s[1] * alpha + d[1] * inverse));
+        out[2] = static_cast<Uint8>(div255(s[2] * alpha + d[2] * inverse));
+        out[3] = static_cast<Uint8>(alpha + div255(d[3] * inverse));
+
+        Uint32 result;
+        std::memcpy(&result, out, 4);
+        return result;
+    }
+
+    void blendSpan(Uint32 *dst, const Uint32 *src, int count)
+    {
+        int i = 0;
+
+#ifdef CPU_BACKEND_SSE2
+        // Four pixels per iteration; alpha is byte 3 of each pixel in memory
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        const __m128i c255 = _mm_set1_epi16(255);
+        const __m128i c128 = _mm_set1_epi16(128);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            __m128i sAlpha = _mm_and_si128(s, alphaMask);
+
+            // Fully transparent or fully opaque groups skip the arithmetic
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(sAlpha, zero)) == 0xFFFF)
+                continue;
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(sAlpha, alphaMask)) == 0xFFFF)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), s);
+                continue;
+            }
+
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+
+            // Replace source alpha by 255 so the alpha lane becomes a + dA * (1 - a)
+            __m128i sOpaque = _mm_or_si128(s, alphaMask);
+            __m128i sLo = _mm_unpacklo_epi8(sOpaque, zero);
+            __m128i sHi = _mm_unpackhi_epi8(sOpaque, zero);
+            __m128i dLo = _mm_unpacklo_epi8(d, zero);
+            __m128i dHi = _mm_unpackhi_epi8(d, zero);
+
+            __m128i aLo = _mm_unpacklo_epi8(s, zero);
+            __m128i aHi = _mm_unpackhi_epi8(s, zero);
+            aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(aLo, 0xFF), 0xFF);
+            aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(aHi, 0xFF), 0xFF);
+            __m128i iaLo = _mm_sub_epi16(c255, aLo);
+            __m128i iaHi = _mm_sub_epi16(c255, aHi);
+
+            __m128i oLo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sLo, aLo), _mm_mullo_epi16(dLo, iaLo)), c128);
+            __m128i oHi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(sHi, aHi), _mm_mullo_epi16(dHi, iaHi)), c128);
+            oLo = _mm_srli_epi16(_mm_add_epi16(oLo, _mm_srli_epi16(oLo, 8)), 8);
+            oHi = _mm_srli_epi16(_mm_add_epi16(oHi, _mm_srli_epi16(oHi, 8)), 8);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(oLo, oHi));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            dst[i] = blendPixel(src[i], dst[i]);
+        }
+    }
+
+    // Multiply texels by a vertex color, as SDL_RenderGeometry does
+    void tintSpan(Uint32 *span, int count, SDL_Color color)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            Uint8 texel[4];
+            std::memcpy(texel, &span[i], 4);
+            texel[0] = static_cast<Uint8>(div255(texel[0] * color.r));
+            texel[1] = static_cast<Uint8>(div255(texel[1] * color.g));
+            texel[2] = static_cast<Uint8>(div255(texel[2] * color.b));
+            texel[3] = static_cast<Uint8>(div255(texel[3] * color.a));
+            std::memcpy(&span[i], texel, 4);
+        }
+    }
+}
+
+CPURenderBackend::CPURenderBackend(ResourceManager *rm, int width, int height, const std::string &dumpDirectory,
+                                   int threadCount)
+    : resourceManager(rm), width(width), height(height),
+      framebuffer(static_cast<size_t>(width) * height, 0), spanBuffer(width),
+      dumpDirectory(dumpDirectory),
+      tilesX((width + TILE_SIZE - 1) / TILE_SIZE), tilesY((height + TILE_SIZE - 1) / TILE_SIZE)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // No point in more threads than tiles
+    threadCount = std::min(threadCount, tilesX * tilesY);
+
+    tileBins.resize(static_cast<size_t>(tilesX) * tilesY);
+    workerSpans.resize(threadCount, std::vector<Uint32>(TILE_SIZE));
+
+    // The calling thread composites too, so spawn one fewer worker
+    for (int i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(&CPURenderBackend::workerLoop, this, i);
+    }
+}
+
+CPURenderBackend::~CPURenderBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void CPURenderBackend::beginFrame(SDL_Color clearColor)
+{
+    Uint8 bytes[4] = {clearColor.r, clearColor.g, clearColor.b, clearColor.a};
+    Uint32 packed;
+    std::memcpy(&packed, bytes, 4);
+    std::fill(framebuffer.begin(), framebuffer.end(), packed);
+}
+
+void CPURenderBackend::submit(const RenderQueue &queue)
+{
+    if (!workers.empty())
+    {
+        submitTiled(queue);
+        return;
+    }
+
+    const SDL_Rect screenRect = {0, 0, width, height};
+
+    // Commands arrive sorted by texture, so the pixel lookup is cached per run
+    SDL_Texture *currentTexture = nullptr;
+    const TexturePixels *pixels = nullptr;
+
+    for (const DrawCommand &command : queue.getCommands())
+    {
+        SDL_Texture *texture = queue.getTexture(command.textureKey);
+        if (texture != currentTexture)
+        {
+            currentTexture = texture;
+            pixels = resourceManager->getTexturePixels(texture);
+        }
+
+        if (pixels && !pixels->pixels.empty())
+        {
+            drawCommand(command, *pixels, screenRect, spanBuffer);
+        }
+    }
+}
+
+void CPURenderBackend::submitTiled(const RenderQueue &queue)
+{
+    const auto &commands = queue.getCommands();
+    if (commands.empty())
+        return;
+
+    // Resolve texture pixels up front so workers never touch the resource maps
+    framePixels.clear();
+    for (const DrawCommand &command : commands)
+    {
+        if (command.textureKey >= framePixels.size())
+        {
+            framePixels.resize(command.textureKey + 1, nullptr);
+        }
+        if (!framePixels[command.textureKey])
+        {
+            framePixels[command.textureKey] = resourceManager->getTexturePixels(queue.getTexture(command.textureKey));
+        }
+    }
+
+    binCommands(queue);
+
+    // Wake the workers and composite alongside them
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        activeQueue = &queue;
+        nextTile.store(0);
+        workersBusy = static_cast<int>(workers.size());
+        workGeneration++;
+    }
+    workReady.notify_all();
+
+    compositeTiles(workerSpans[0]);
+
+    std::unique_lock<std::mutex> lock(workMutex);
+    workDone.wait(lock, [this] { return workersBusy == 0; });
+    activeQueue = nullptr;
+}
+
+void CPURenderBackend::binCommands(const RenderQueue &queue)
+{
+    PROFILE_ZONE("Bin draw commands");
+
+    for (auto &bin : tileBins)
+    {
+        bin.clear();
+    }
+
+    const auto &commands = queue.getCommands();
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        const SDL_FRect &dest = commands[i].dest;
+        if (dest.w <= 0.0f || dest.h <= 0.0f)
+            continue;
+
+        // Same pixel coverage rule as drawCommand, clamped to the screen
+        int x0 = std::max(static_cast<int>(std::ceil(dest.x - 0.5f)), 0);
+        int y0 = std::max(static_cast<int>(std::ceil(dest.y - 0.5f)), 0);
+        int x1 = std::min(static_cast<int>(std::ceil(dest.x + dest.w - 0.5f)), width);
+        int y1 = std::min(static_cast<int>(std::ceil(dest.y + dest.h - 0.5f)), height);
+        if (x0 >= x1 || y0 >= y1)
+            continue;
+
+        for (int ty = y0 / TILE_SIZE; ty <= (y1 - 1) / TILE_SIZE; ++ty)
+        {
+            for (int tx = x0 / TILE_SIZE; tx <= (x1 - 1) / TILE_SIZE; ++tx)
+            {
+                tileBins[static_cast<size_t>(ty) * tilesX + tx].push_back(static_cast<Uint32>(i));
+            }
+        }
+    }
+}
+
+void CPURenderBackend::compositeTiles(std::vector<Uint32> &span)
+{
+    PROFILE_ZONE("Composite tiles");
+
+    const auto &commands = activeQueue->getCommands();
+    const int tileCount = tilesX * tilesY;
+
+    // Tiles are handed out dynamically so crowded tiles don't stall one thread
+    for (int tile = nextTile.fetch_add(1); tile < tileCount; tile = nextTile.fetch_add(1))
+    {
+        const auto &bin = tileBins[tile];
+        if (bin.empty())
+            continue;
+
+        SDL_Rect tileRect = {(tile % tilesX) * TILE_SIZE, (tile / tilesX) * TILE_SIZE, TILE_SIZE, TILE_SIZE};
+        tileRect.w = std::min(tileRect.w, width - tileRect.x);
+        tileRect.h = std::min(tileRect.h, height - tileRect.y);
+
+        for (Uint32 index : bin)
+        {
+            const DrawCommand &command = commands[index];
+            const TexturePixels *pixels = framePixels[command.textureKey];
+            if (pixels && !pixels->pixels.empty())
+            {
+                drawCommand(command, *pixels, tileRect, span);
+            }
+        }
+    }
+}
+
+void CPURenderBackend::workerLoop(int workerIndex)
+{
+    Profiler::setThreadName("Render worker");
+    Uint64 seenGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(workMutex);
+            workReady.wait(lock, [&] { return stopping || workGeneration != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = workGeneration;
+        }
+
+        compositeTiles(workerSpans[workerIndex]);
+
+        {
+            std::lock_guard<std::mutex> lock(workMutex);
+            workersBusy--;
+        }
+        workDone.notify_one();
+    }
+}
+
+void CPURenderBackend::endFrame()
+{
+    if (!dumpDirectory.empty())
+    {
+        PROFILE_ZONE("Dump frame");
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "frame_%06d.ppm", frameIndex);
+        if (!writeFrame(dumpDirectory + "/" + fileName))
+        {
+            std::cerr << "Failed to write frame dump to " << dumpDirectory << std::endl;
+            dumpDirectory.clear(); // Don't retry every frame
+        }
+    }
+
+    frameIndex++;
+}
+
+void CPURenderBackend::drawCommand(const DrawCommand &command, const TexturePixels &texture,
+                                   const SDL_Rect &clipRect, std::vector<Uint32> &span)
+{
+    const SDL_FRect &dest = command.dest;
+    if (dest.w <= 0.0f || dest.h <= 0.0f)
+        return;
+
+    // Pixels whose centers fall inside the destination, clipped to the target
+    int left = static_cast<int>(std::ceil(dest.x - 0.5f));
+    int x0 = std::max(left, clipRect.x);
+    int y0 = std::max(static_cast<int>(std::ceil(dest.y - 0.5f)), clipRect.y);
+    int x1 = std::min(static_cast<int>(std::ceil(dest.x + dest.w - 0.5f)), clipRect.x + clipRect.w);
+    int y1 = std::min(static_cast<int>(std::ceil(dest.y + dest.h - 0.5f)), clipRect.y + clipRect.h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    // Flipping is just swapping texture coordinates
+    float u0 = command.u0, u1 = command.u1;
+    float v0 = command.v0, v1 = command.v1;
+    if (command.flip & SDL_FLIP_HORIZONTAL)
+        std::swap(u0, u1);
+    if (command.flip & SDL_FLIP_VERTICAL)
+        std::swap(v0, v1);
+
+    float texelsPerPixelX = (u1 - u0) * texture.width / dest.w;
+    float texelsPerPixelY = (v1 - v0) * texture.height / dest.h;
+
+    // Horizontal texel position in 16.16 fixed point. It is anchored at the unclipped
+    // left edge and stepped in integers, so tiles sample exactly like a full-screen draw.
+    Sint32 uStep = static_cast<Sint32>(texelsPerPixelX * 65536.0f);
+    Sint32 uLeft = static_cast<Sint32>((u0 * texture.width + (left + 0.5f - dest.x) * texelsPerPixelX) * 65536.0f);
+    Sint32 uStart = uLeft + (x0 - left) * uStep;
+
+    int spanLength = x1 - x0;
+    if (static_cast<int>(span.size()) < spanLength)
+        span.resize(spanLength);
+
+    bool tinted = command.color.r != 255 || command.color.g != 255 ||
+                  command.color.b != 255 || command.color.a != 255;
+    int maxX = texture.width - 1;
+    int maxY = texture.height - 1;
+
+    for (int y = y0; y < y1; ++y)
+    {
+        int ty = static_cast<int>(std::floor(v0 * texture.height + (y + 0.5f - dest.y) * texelsPerPixelY));
+        ty = std::min(std::max(ty, 0), maxY);
+        const Uint32 *srcRow = texture.pixels.data() + static_cast<size_t>(ty) * texture.width;
+
+        // Gather the row span, then blend it in one pass
+        Sint32 u = uStart;
+        for (int i = 0; i < spanLength; ++i)
+        {
+            int tx = std::min(std::max(static_cast<int>(u >> 16), 0), maxX);
+            span[i] = srcRow[tx];
+            u += uStep;
+        }
+
+        if (tinted)
+            tintSpan(span.data(), spanLength, command.color);
+
+        blendSpan(framebuffer.data() + static_cast<size_t>(y) * width + x0, span.data(), spanLength);
+    }
+}
+
+bool CPURenderBackend::writeFrame(const std::string &path) const
+{
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    // Binary PPM: no dependencies and readable by most image tools
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<Uint8> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            Uint8 pixel[4];
+            std::memcpy(pixel, &framebuffer[static_cast<size_t>(y) * width + x], 4);
+            row[x * 3 + 0] = pixel[0];
+            row[x * 3 + 1] = pixel[1];
+            row[x * 3 + 2] = pixel[2];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "RenderBackend.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ResourceManager; // Forward declaration
+struct TexturePixels;
+
+// Software backend: composites draw commands into an offscreen RGBA32 buffer
+// using the CPU copies of textures kept by ResourceManager. Used for headless
+// benchmarks and frame dumps on machines without a GPU.
+//
+// With more than one thread the screen is split into tiles; commands are
+// binned per tile in submission order and tiles are composited in parallel.
+// Every pixel still sees its commands in the same order and sampling does not
+// depend on the clip, so the output is identical to the single-threaded path.
+class CPURenderBackend : public RenderBackend
+{
+private:
+    ResourceManager *resourceManager;
+    int width, height;
+    std::vector<Uint32> framebuffer; // SDL_PIXELFORMAT_RGBA32, width * height
+    std::vector<Uint32> spanBuffer;  // Sampled texels for one destination row
+
+    std::string dumpDirectory; // Frames are written here as PPM when not empty
+    int frameIndex = 0;
+
+    // Tiled parallel compositing
+    static constexpr int TILE_SIZE = 64;
+    int tilesX, tilesY;
+    std::vector<std::vector<Uint32>> tileBins;         // Command indices per tile, in draw order
+    std::vector<const TexturePixels *> framePixels;    // Resolved per texture key before dispatch
+    std::vector<std::vector<Uint32>> workerSpans;      // One span buffer per thread (index 0 = caller)
+    std::vector<std::thread> workers;
+
+    std::mutex workMutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    Uint64 workGeneration = 0;
+    int workersBusy = 0;
+    bool stopping = false;
+    std::atomic<int> nextTile{0};
+    const RenderQueue *activeQueue = nullptr;
+
+public:
+    // threadCount: 0 = one per hardware thread, 1 = single-threaded compositing
+    CPURenderBackend(ResourceManager *rm, int width, int height, const std::string &dumpDirectory = "",
+                     int threadCount = 1);
+    ~CPURenderBackend();
+
+    void beginFrame(SDL_Color clearColor) override;
+    void submit(const RenderQueue &queue) override;
+    void endFrame() override;
+    bool supportsRenderTargets() const override { return false; }
+    const char *getName() const override { return "cpu"; }
+
+    const std::vector<Uint32> &getPixels() const { return framebuffer; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+private:
+    // Draw one command clipped to clipRect, sampling nearest texels row span by row span
+    void drawCommand(const DrawCommand &command, const TexturePixels &texture,
+                     const SDL_Rect &clipRect, std::vector<Uint32> &span);
+    bool writeFrame(const std::string &path) const;
+
+    void submitTiled(const RenderQueue &queue);
+    void binCommands(const RenderQueue &queue);
+    void compositeTiles(std::vector<Uint32> &span);
+    void workerLoop(int workerIndex);
+};
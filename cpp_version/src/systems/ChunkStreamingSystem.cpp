@@ -0,0 +1,134 @@
+#include "ChunkStreamingSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+ChunkStreamingSystem::ChunkStreamingSystem(const Camera *camera, float chunkSize, int activeRadius,
+                                           size_t maxDormantPerChunk)
+    : camera(camera), chunkSize(std::max(chunkSize, 1.0f)), activeRadius(std::max(activeRadius, 1)),
+      maxDormantPerChunk(std::max<size_t>(maxDormantPerChunk, 1)), dormantCount(0), wasPlaying(false) {}
+
+int ChunkStreamingSystem::toChunk(float coordinate) const
+{
+    return static_cast<int>(std::floor(coordinate / chunkSize));
+}
+
+Uint64 ChunkStreamingSystem::chunkKey(int chunkX, int chunkY)
+{
+    return (static_cast<Uint64>(static_cast<Uint32>(chunkX)) << 32) | static_cast<Uint32>(chunkY);
+}
+
+void ChunkStreamingSystem::update(ECS &ecs, GameManager &gameManager, float deltaTime)
+{
+    // A new round starts from an empty world (InputSystem clears the live mobs)
+    bool playing = gameManager.currentState == GameManager::PLAYING;
+    if (playing && !wasPlaying)
+    {
+        clear();
+    }
+    wasPlaying = playing;
+    if (!playing)
+        return;
+
+    int cameraChunkX = toChunk(camera->getCenterX());
+    int cameraChunkY = toChunk(camera->getCenterY());
+
+    // Stream out: mobs more than one chunk beyond the active radius go to sleep.
+    // The extra chunk is hysteresis so mobs on a border don't flip every frame.
+    sleepers.clear();
+    auto &mobTags = ecs.getComponents<MobTag>();
+    for (auto &[entityID, mobTag] : mobTags)
+    {
+        auto *transform = ecs.getComponent<Transform>(entityID);
+        if (!transform)
+            continue;
+
+        int distanceX = std::abs(toChunk(transform->x) - cameraChunkX);
+        int distanceY = std::abs(toChunk(transform->y) - cameraChunkY);
+        if (std::max(distanceX, distanceY) > activeRadius + 1)
+        {
+            sleepers.push_back(entityID);
+        }
+    }
+    for (EntityID entityID : sleepers)
+    {
+        auto *transform = ecs.getComponent<Transform>(entityID);
+        putToSleep(ecs, entityID, toChunk(transform->x), toChunk(transform->y));
+    }
+
+    // Stream in: wake every dormant chunk inside the active radius
+    if (dormantCount == 0)
+        return;
+
+    for (int chunkY = cameraChunkY - activeRadius; chunkY <= cameraChunkY + activeRadius; ++chunkY)
+    {
+        for (int chunkX = cameraChunkX - activeRadius; chunkX <= cameraChunkX + activeRadius; ++chunkX)
+        {
+            auto it = dormantChunks.find(chunkKey(chunkX, chunkY));
+            if (it == dormantChunks.end())
+                continue;
+
+            for (const DormantMob &mob : it->second)
+            {
+                wake(ecs, mob);
+            }
+            dormantCount -= it->second.size();
+            dormantChunks.erase(it);
+        }
+    }
+}
+
+void ChunkStreamingSystem::putToSleep(ECS &ecs, EntityID entityID, int chunkX, int chunkY)
+{
+    auto *entityType = ecs.getComponent<EntityType>(entityID);
+    auto *transform = ecs.getComponent<Transform>(entityID);
+    auto *velocity = ecs.getComponent<Velocity>(entityID);
+    auto *speed = ecs.getComponent<Speed>(entityID);
+    auto *direction = ecs.getComponent<MovementDirection>(entityID);
+    auto *sprite = ecs.getComponent<Sprite>(entityID);
+    auto *collider = ecs.getComponent<Collider>(entityID);
+    auto *animation = ecs.getComponent<Animation>(entityID);
+
+    if (entityType && transform && velocity && speed && direction && sprite && collider)
+    {
+        std::vector<DormantMob> &chunk = dormantChunks[chunkKey(chunkX, chunkY)];
+
+        // A chunk only remembers its most recent sleepers
+        if (chunk.size() >= maxDormantPerChunk)
+        {
+            chunk.erase(chunk.begin());
+            dormantCount--;
+        }
+
+        DormantMob mob = {*entityType, *transform, *velocity, *speed, *direction, *sprite, *collider,
+                          animation ? *animation : Animation(), animation != nullptr};
+        chunk.push_back(mob);
+        dormantCount++;
+    }
+
+    ecs.removeEntity(entityID);
+}
+
+void ChunkStreamingSystem::wake(ECS &ecs, const DormantMob &mob)
+{
+    EntityID entityID = ecs.createEntity();
+    ecs.addComponent(entityID, MobTag{});
+    ecs.addComponent(entityID, mob.entityType);
+    ecs.addComponent(entityID, mob.transform);
+    ecs.addComponent(entityID, PreviousTransform(mob.transform.x, mob.transform.y));
+    ecs.addComponent(entityID, mob.velocity);
+    ecs.addComponent(entityID, mob.speed);
+    ecs.addComponent(entityID, mob.direction);
+    ecs.addComponent(entityID, mob.sprite);
+    ecs.addComponent(entityID, mob.collider);
+    if (mob.hasAnimation)
+    {
+        ecs.addComponent(entityID, mob.animation);
+    }
+}
+
+void ChunkStreamingSystem::clear()
+{
+    dormantChunks.clear();
+    dormantCount = 0;
+}
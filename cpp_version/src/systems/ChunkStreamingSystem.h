@@ -0,0 +1,54 @@
+#pragma once
+#include "System.h"
+#include "../core/Camera.h"
+#include "../components/Components.h"
+#include <unordered_map>
+#include <vector>
+
+// Splits the world into square chunks and keeps only mobs near the camera
+// alive in the ECS. Mobs that end up beyond the active radius are serialised
+// into their chunk's dormant list (frozen, no per-frame cost) and respawned
+// when the camera comes back. Work per update depends on the active radius
+// and the number of live mobs, never on the world size.
+class ChunkStreamingSystem : public System
+{
+private:
+    // Everything needed to recreate a mob exactly as it was put to sleep
+    struct DormantMob
+    {
+        EntityType entityType;
+        Transform transform;
+        Velocity velocity;
+        Speed speed;
+        MovementDirection direction;
+        Sprite sprite;
+        Collider collider;
+        Animation animation;
+        bool hasAnimation;
+    };
+
+    const Camera *camera;
+    float chunkSize;
+    int activeRadius;       // Chunks within this distance of the camera's chunk are awake
+    size_t maxDormantPerChunk;
+
+    std::unordered_map<Uint64, std::vector<DormantMob>> dormantChunks;
+    size_t dormantCount;
+    bool wasPlaying;
+    std::vector<EntityID> sleepers; // Scratch list reused between updates
+
+    int toChunk(float coordinate) const;
+    static Uint64 chunkKey(int chunkX, int chunkY);
+
+    void putToSleep(ECS &ecs, EntityID entityID, int chunkX, int chunkY);
+    void wake(ECS &ecs, const DormantMob &mob);
+    void clear();
+
+public:
+    ChunkStreamingSystem(const Camera *camera, float chunkSize, int activeRadius, size_t maxDormantPerChunk = 32);
+
+    void update(ECS &ecs, GameManager &gameManager, float deltaTime) override;
+
+    size_t getDormantCount() const { return dormantCount; }
+    size_t getDormantChunkCount() const { return dormantChunks.size(); }
+};
@@ -70,7 +70,9 @@ void CollisionSystem::handlePlayerMobCollision(ECS &ecs, GameManager &gameManage
     // Play death sound effect
     if (audioSystem)
     {
-        audioSystem->playSound("gameover");
+        if (!gameOverSound.isValid())
+            gameOverSound = audioSystem->findSound("gameover");
+        audioSystem->playSound(gameOverSound);
     }
 
     // Change game state to game over
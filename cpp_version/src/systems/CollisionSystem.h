@@ -9,6 +9,7 @@ class CollisionSystem : public System
 {
 private:
     AudioSystem *audioSystem;
+    SoundHandle gameOverSound; // Resolved on first use (sounds load after systems are created)
 
 public:
     CollisionSystem(AudioSystem *audio) : audioSystem(audio) {}
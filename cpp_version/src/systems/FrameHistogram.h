@@ -0,0 +1,109 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Percentiles of one histogram, in milliseconds
+struct FrameTimeSummary
+{
+    float p50 = 0.0f;
+    float p90 = 0.0f;
+    float p99 = 0.0f;
+    float p999 = 0.0f;
+    float max = 0.0f;
+    Uint64 count = 0;
+    Uint64 overBudget = 0; // Filled in by TimingSystem for frame times
+};
+
+// HDR-style histogram of durations in microseconds: exact below 128 us, then
+// 64 buckets per power of two, so a reported value is within 1.6% of the
+// recorded one from 1 us to over two minutes. Recording is O(1) and never
+// allocates.
+class FrameHistogram
+{
+private:
+    static constexpr int SUB_BUCKETS = 64;       // Per power of two above the linear range
+    static constexpr int LINEAR_LIMIT = 2 * SUB_BUCKETS;
+    static constexpr int MAX_SHIFT = 20;         // Largest value 2^27 us (134 s), larger ones are clamped
+    static constexpr int BUCKET_COUNT = (MAX_SHIFT + 2) * SUB_BUCKETS;
+    static constexpr Uint64 MAX_VALUE = (Uint64(1) << (MAX_SHIFT + 7)) - 1;
+
+    std::array<Uint32, BUCKET_COUNT> buckets{};
+    Uint64 count = 0;
+    Uint64 maxValue = 0;
+    double total = 0.0;
+
+    static int bucketIndex(Uint64 value)
+    {
+        if (value < LINEAR_LIMIT)
+            return static_cast<int>(value);
+        int magnitude = 0;
+        for (Uint64 v = value; v > 1; v >>= 1)
+            magnitude++;
+        int shift = magnitude - 6; // Keeps value >> shift in [64, 128)
+        return shift * SUB_BUCKETS + static_cast<int>(value >> shift);
+    }
+
+    // Largest value that lands in the bucket, so percentiles never understate a hitch
+    static Uint64 bucketHighest(int index)
+    {
+        if (index < LINEAR_LIMIT)
+            return static_cast<Uint64>(index);
+        int shift = index / SUB_BUCKETS - 1;
+        Uint64 lowest = static_cast<Uint64>(index - shift * SUB_BUCKETS) << shift;
+        return lowest + (Uint64(1) << shift) - 1;
+    }
+
+public:
+    void record(float seconds)
+    {
+        Uint64 micros = static_cast<Uint64>(std::max(seconds, 0.0f) * 1e6f + 0.5f);
+        micros = std::min(micros, MAX_VALUE);
+        buckets[bucketIndex(micros)]++;
+        count++;
+        maxValue = std::max(maxValue, micros);
+        total += seconds;
+    }
+
+    void reset()
+    {
+        buckets.fill(0);
+        count = 0;
+        maxValue = 0;
+        total = 0.0;
+    }
+
+    Uint64 getCount() const { return count; }
+    float getMeanMs() const { return count > 0 ? static_cast<float>(total * 1000.0 / count) : 0.0f; }
+    float getMaxMs() const { return maxValue / 1000.0f; }
+
+    // Smallest recorded duration that `percent` of the samples do not exceed
+    float getPercentileMs(float percent) const
+    {
+        if (count == 0)
+            return 0.0f;
+        Uint64 target = static_cast<Uint64>(std::ceil(count * static_cast<double>(percent) / 100.0));
+        target = std::max<Uint64>(target, 1);
+        Uint64 seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= target)
+                return std::min(bucketHighest(i), maxValue) / 1000.0f;
+        }
+        return getMaxMs();
+    }
+
+    FrameTimeSummary getSummary() const
+    {
+        FrameTimeSummary result;
+        result.p50 = getPercentileMs(50.0f);
+        result.p90 = getPercentileMs(90.0f);
+        result.p99 = getPercentileMs(99.0f);
+        result.p999 = getPercentileMs(99.9f);
+        result.max = getMaxMs();
+        result.count = count;
+        return result;
+    }
+};
@@ -1,10 +1,19 @@
 #include "InputSystem.h"
 #include "../components/Components.h"
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 InputSystem::InputSystem()
 {
-    keyboardState = SDL_GetKeyboardState(nullptr);
+    std::memset(keyboardState, 0, sizeof(keyboardState));
+}
+
+void InputSystem::captureKeyboardState()
+{
+    int keyCount = 0;
+    const Uint8 *state = SDL_GetKeyboardState(&keyCount);
+    std::memcpy(keyboardState, state, std::min(keyCount, static_cast<int>(SDL_NUM_SCANCODES)));
 }
 
 void InputSystem::update(ECS &ecs, GameManager &gameManager, float deltaTime)
@@ -5,10 +5,13 @@
 class InputSystem : public System
 {
 private:
-    const Uint8 *keyboardState;
+    Uint8 keyboardState[SDL_NUM_SCANCODES]; // Copied on the main thread, read by the simulation
     void clearAllMobs(ECS &ecs);
 
 public:
     InputSystem();
+
+    // Snapshot SDL's keyboard state; call on the event thread after pumping events
+    void captureKeyboardState();
     void update(ECS &ecs, GameManager &gameManager, float deltaTime) override;
 };
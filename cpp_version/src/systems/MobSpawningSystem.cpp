@@ -3,14 +3,19 @@
 #include <iostream>
 #include <chrono>
 
-MobSpawningSystem::MobSpawningSystem(EntityFactory *factory, float screenW, float screenH)
+MobSpawningSystem::MobSpawningSystem(EntityFactory *factory, const Camera *camera)
     : entityFactory(factory), timeSinceLastSpawn(0.0f), spawnInterval(0.5f),
-      screenWidth(screenW), screenHeight(screenH),
+      camera(camera),
       randomGenerator(std::chrono::steady_clock::now().time_since_epoch().count()),
       mobTypeDistribution(0, 2), // 0-2 for 3 mob types
       positionDistribution(0.0f, 1.0f),
       speedDistribution(0.0f, 1.0f)
 {
+    for (const auto &mobType : mobTypes)
+    {
+        mobTypeIds.push_back(entityFactory->getTypeId(mobType));
+        mobSpriteTypeIds.push_back(entityFactory->getSpriteTypeId(mobType));
+    }
 }
 
 void MobSpawningSystem::update(ECS &ecs, GameManager &gameManager, float deltaTime)
@@ -54,7 +59,12 @@ void MobSpawningSystem::spawnMob(ECS &ecs)
     ecs.addComponent(mobEntity, MobTag{});
 
     // Add EntityType component for texture identification
-    ecs.addComponent(mobEntity, EntityType{mobType});
+    ecs.addComponent(mobEntity, EntityType(mobTypeIds[mobTypeIndex]));
+
+    // Spawn relative to the current view
+    SDL_FRect view = camera->getView();
+    float screenWidth = view.w;
+    float screenHeight = view.h;
 
     // Determine spawn edge and direction randomly
     int edge = std::uniform_int_distribution<int>(0, 3)(randomGenerator); // 0=right, 1=left, 2=top, 3=bottom
@@ -94,12 +104,17 @@ void MobSpawningSystem::spawnMob(ECS &ecs)
         break;
     }
 
+    // View space to world space
+    spawnX += view.x;
+    spawnY += view.y;
+
     // Create Transform component
     Transform transform;
     transform.x = spawnX;
     transform.y = spawnY;
     transform.rotation = 0.0f;
     ecs.addComponent(mobEntity, transform);
+    ecs.addComponent(mobEntity, PreviousTransform(spawnX, spawnY));
 
     // Add MovementDirection component for proper sprite orientation
     ecs.addComponent(mobEntity, MovementDirection(facingDirection));
@@ -107,12 +122,12 @@ void MobSpawningSystem::spawnMob(ECS &ecs)
     // Create Sprite component
     json spriteConfig = mobConfig["sprite"];
     Sprite sprite;
-    sprite.texture = nullptr; // Will be loaded by ResourceManager in RenderSystem
     sprite.width = spriteConfig["width"].get<int>();
     sprite.height = spriteConfig["height"].get<int>();
     sprite.frameCount = spriteConfig["frameCount"].get<int>();
     sprite.frameTime = spriteConfig["frameTime"].get<float>();
     sprite.animated = spriteConfig["animated"].get<bool>();
+    sprite.spriteTypeId = mobSpriteTypeIds[mobTypeIndex];
     ecs.addComponent(mobEntity, sprite);
 
     // Create Animation component if animated
@@ -3,6 +3,7 @@
 #include "../core/ECS.h"
 #include "../managers/GameManager.h"
 #include "../managers/EntityFactory.h"
+#include "../core/Camera.h"
 #include <random>
 
 class MobSpawningSystem : public System
@@ -16,15 +17,16 @@ private:
     std::uniform_real_distribution<float> positionDistribution;
     std::uniform_real_distribution<float> speedDistribution;
 
-    // Screen dimensions for spawning
-    float screenWidth;
-    float screenHeight;
+    // Mobs spawn just outside the camera view
+    const Camera *camera;
 
-    // Mob types
+    // Mob types, with their interned entity type and sprite type IDs resolved at construction
     std::vector<std::string> mobTypes = {"flying", "swimming", "walking"};
+    std::vector<EntityTypeId> mobTypeIds;
+    std::vector<int> mobSpriteTypeIds;
 
 public:
-    MobSpawningSystem(EntityFactory *factory, float screenW, float screenH);
+    MobSpawningSystem(EntityFactory *factory, const Camera *camera);
     void update(ECS &ecs, GameManager &gameManager, float deltaTime) override;
 
 private:
@@ -0,0 +1,371 @@
+#include "MusicStreamer.h"
+#include "../core/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    constexpr size_t FRAME_BYTES = 2 * sizeof(Sint16); // 16-bit stereo
+    constexpr int DECODE_INTERVAL_MS = 10;             // Decoder wake-up period when idle
+
+    // libvorbisfile reads through SDL_RWops, so loose files and bundle mappings share one path
+    size_t readCallback(void *buffer, size_t size, size_t count, void *source)
+    {
+        return SDL_RWread(static_cast<SDL_RWops *>(source), buffer, size, count);
+    }
+
+    int seekCallback(void *source, ogg_int64_t offset, int whence)
+    {
+        // SEEK_SET/CUR/END match RW_SEEK_SET/CUR/END
+        return SDL_RWseek(static_cast<SDL_RWops *>(source), offset, whence) < 0 ? -1 : 0;
+    }
+
+    long tellCallback(void *source)
+    {
+        return static_cast<long>(SDL_RWtell(static_cast<SDL_RWops *>(source)));
+    }
+
+    // The stream is closed by its owner, not by ov_clear
+    const ov_callbacks RWOPS_CALLBACKS = {readCallback, seekCallback, nullptr, tellCallback};
+
+    SDL_RWops *openSource(const MusicSource &source)
+    {
+        SDL_RWops *stream = source.bundled ? AssetBundle::openStream(*source.bundled)
+                                           : SDL_RWFromFile(source.path.c_str(), "rb");
+        if (!stream)
+            std::cerr << "Failed to open music '" << source.path << "': " << SDL_GetError() << std::endl;
+        return stream;
+    }
+}
+
+MusicStreamer::MusicStreamer(int outputFrequency) : outputFrequency(outputFrequency)
+{
+    // All sample memory is allocated here, once
+    for (Slot &slot : slots)
+        slot.ring.resize(RING_FRAMES * 2);
+    decodeBuffer.resize(DECODE_BUFFER_BYTES);
+
+    decoder = std::thread(&MusicStreamer::decoderLoop, this);
+}
+
+MusicStreamer::~MusicStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wake.notify_one();
+    decoder.join();
+
+    for (Slot &slot : slots)
+        closeSlot(slot);
+}
+
+bool MusicStreamer::probe(const MusicSource &source)
+{
+    SDL_RWops *stream = openSource(source);
+    if (!stream)
+        return false;
+
+    OggVorbis_File file;
+    bool valid = ov_open_callbacks(stream, &file, nullptr, 0, RWOPS_CALLBACKS) == 0;
+    if (valid)
+        ov_clear(&file);
+    else
+        std::cerr << "Music '" << source.path << "' is not an Ogg Vorbis stream" << std::endl;
+    SDL_RWclose(stream);
+    return valid;
+}
+
+bool MusicStreamer::play(const MusicSource &source, bool loop, float fadeSeconds)
+{
+    stop(fadeSeconds);
+
+    auto findFreeSlot = [this]() -> Slot * {
+        for (Slot &slot : slots)
+        {
+            if (slot.state.load(std::memory_order_acquire) == FREE)
+                return &slot;
+        }
+        return nullptr;
+    };
+
+    Slot *slot = findFreeSlot();
+    if (!slot && blockingReads)
+    {
+        // Offline: finished slots are freed by the next decoder pass, so wait for it
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.notify_one();
+        progress.wait(lock, [this]() {
+            return std::none_of(std::begin(slots), std::end(slots), [](const Slot &s) {
+                return s.state.load(std::memory_order_acquire) == FINISHED;
+            });
+        });
+        slot = findFreeSlot();
+    }
+    if (!slot)
+        return false;
+
+    // The slot is FREE, so no other thread reads any of this until REQUESTED is published
+    slot->source = source;
+    slot->loop = loop;
+    slot->fadeStep.store(fadeSeconds > 0.0f ? 1.0f / (fadeSeconds * outputFrequency) : 1.0f,
+                         std::memory_order_relaxed);
+    slot->stopping.store(false, std::memory_order_relaxed);
+    slot->ended.store(false, std::memory_order_relaxed);
+    slot->readFrame.store(0, std::memory_order_relaxed);
+    slot->writeFrame.store(0, std::memory_order_relaxed);
+    slot->gain = 0.0f;
+    slot->state.store(REQUESTED, std::memory_order_release);
+    wake.notify_one();
+    return true;
+}
+
+void MusicStreamer::stop(float fadeSeconds)
+{
+    float step = fadeSeconds > 0.0f ? 1.0f / (fadeSeconds * outputFrequency) : 1.0f;
+    for (Slot &slot : slots)
+    {
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == REQUESTED || state == PLAYING)
+        {
+            slot.fadeStep.store(step, std::memory_order_relaxed);
+            slot.stopping.store(true, std::memory_order_release);
+        }
+    }
+}
+
+bool MusicStreamer::hasPendingWork() const
+{
+    return std::any_of(std::begin(slots), std::end(slots), [](const Slot &slot) {
+        int state = slot.state.load(std::memory_order_acquire);
+        return state == REQUESTED || state == FINISHED;
+    });
+}
+
+void MusicStreamer::decoderLoop()
+{
+    Profiler::setThreadName("Music decoder");
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested)
+    {
+        for (Slot &slot : slots)
+        {
+            switch (slot.state.load(std::memory_order_acquire))
+            {
+            case REQUESTED:
+                // Prefill before publishing so playback starts with a full ring
+                if (openSlot(slot))
+                {
+                    fillSlot(slot);
+                    slot.state.store(PLAYING, std::memory_order_release);
+                }
+                else
+                {
+                    closeSlot(slot);
+                    slot.state.store(FREE, std::memory_order_release);
+                }
+                break;
+            case PLAYING:
+                fillSlot(slot);
+                break;
+            case FINISHED:
+                closeSlot(slot);
+                slot.state.store(FREE, std::memory_order_release);
+                break;
+            default:
+                break;
+            }
+        }
+        progress.notify_all();
+
+        if (!hasPendingWork())
+            wake.wait_for(lock, std::chrono::milliseconds(DECODE_INTERVAL_MS));
+    }
+}
+
+bool MusicStreamer::openSlot(Slot &slot)
+{
+    slot.stream = openSource(slot.source);
+    if (!slot.stream)
+        return false;
+
+    if (ov_open_callbacks(slot.stream, &slot.file, nullptr, 0, RWOPS_CALLBACKS) != 0)
+    {
+        std::cerr << "Music '" << slot.source.path << "' is not an Ogg Vorbis stream" << std::endl;
+        return false;
+    }
+    slot.fileOpen = true;
+
+    // Converts the track's rate and channel count to the output format as it decodes
+    vorbis_info *info = ov_info(&slot.file, -1);
+    slot.converter = SDL_NewAudioStream(AUDIO_S16SYS, static_cast<Uint8>(info->channels), static_cast<int>(info->rate),
+                                        AUDIO_S16SYS, 2, outputFrequency);
+    if (!slot.converter)
+    {
+        std::cerr << "Failed to create music converter: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    slot.flushed = false;
+    return true;
+}
+
+void MusicStreamer::closeSlot(Slot &slot)
+{
+    if (slot.converter)
+    {
+        SDL_FreeAudioStream(slot.converter);
+        slot.converter = nullptr;
+    }
+    if (slot.fileOpen)
+    {
+        ov_clear(&slot.file);
+        slot.fileOpen = false;
+    }
+    if (slot.stream)
+    {
+        SDL_RWclose(slot.stream);
+        slot.stream = nullptr;
+    }
+}
+
+void MusicStreamer::fillSlot(Slot &slot)
+{
+    if (slot.ended.load(std::memory_order_relaxed))
+        return;
+
+    size_t write = slot.writeFrame.load(std::memory_order_relaxed);
+    size_t space = RING_FRAMES - (write - slot.readFrame.load(std::memory_order_acquire));
+    if (space < REFILL_FRAMES)
+        return;
+
+    PROFILE_ZONE("Decode music");
+
+    bool seekedWithoutData = false;
+    while (space > 0)
+    {
+        // Move converted frames into the ring, up to the wrap point
+        int converted = SDL_AudioStreamAvailable(slot.converter) / static_cast<int>(FRAME_BYTES);
+        if (converted > 0)
+        {
+            size_t offset = write & (RING_FRAMES - 1);
+            size_t count = std::min({space, static_cast<size_t>(converted), RING_FRAMES - offset});
+            int got = SDL_AudioStreamGet(slot.converter, &slot.ring[offset * 2], static_cast<int>(count * FRAME_BYTES));
+            if (got <= 0)
+                break;
+            write += static_cast<size_t>(got) / FRAME_BYTES;
+            space -= static_cast<size_t>(got) / FRAME_BYTES;
+            slot.writeFrame.store(write, std::memory_order_release);
+            continue;
+        }
+        if (slot.flushed)
+        {
+            slot.ended.store(true, std::memory_order_release);
+            return;
+        }
+
+        int section = 0;
+        long bytes = ov_read(&slot.file, decodeBuffer.data(), DECODE_BUFFER_BYTES,
+                             SDL_BYTEORDER == SDL_BIG_ENDIAN, 2, 1, &section);
+        if (bytes > 0)
+        {
+            SDL_AudioStreamPut(slot.converter, decodeBuffer.data(), static_cast<int>(bytes));
+            seekedWithoutData = false;
+        }
+        else if (bytes == OV_HOLE)
+        {
+            continue; // Recoverable gap in the stream
+        }
+        else if (bytes == 0 && slot.loop && !seekedWithoutData)
+        {
+            // The converter keeps its state across the seek, so the loop point is seamless
+            ov_pcm_seek(&slot.file, 0);
+            seekedWithoutData = true;
+        }
+        else
+        {
+            // End of a track that doesn't loop, or a decode error
+            SDL_AudioStreamFlush(slot.converter);
+            slot.flushed = true;
+        }
+    }
+}
+
+void MusicStreamer::mix(Sint16 *out, size_t frames)
+{
+    std::fill(out, out + frames * 2, static_cast<Sint16>(0));
+    if (paused.load(std::memory_order_relaxed))
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (blockingReads)
+    {
+        // Requests made this frame start this frame
+        lock.lock();
+        while (std::any_of(std::begin(slots), std::end(slots), [](const Slot &slot) {
+            return slot.state.load(std::memory_order_acquire) == REQUESTED;
+        }))
+        {
+            wake.notify_one();
+            progress.wait(lock);
+        }
+    }
+
+    float level = volume.load(std::memory_order_relaxed) / 128.0f;
+    for (Slot &slot : slots)
+    {
+        if (slot.state.load(std::memory_order_acquire) != PLAYING)
+            continue;
+
+        float step = slot.fadeStep.load(std::memory_order_relaxed);
+        bool stopping = slot.stopping.load(std::memory_order_acquire);
+        size_t done = 0;
+        while (done < frames)
+        {
+            // ended is read first: once set, writeFrame is final
+            bool ended = slot.ended.load(std::memory_order_acquire);
+            size_t read = slot.readFrame.load(std::memory_order_relaxed);
+            size_t available = slot.writeFrame.load(std::memory_order_acquire) - read;
+            if (blockingReads && !ended && available < std::min(frames - done, RING_FRAMES / 2))
+            {
+                wake.notify_one();
+                progress.wait(lock);
+                continue;
+            }
+
+            size_t count = std::min(frames - done, available);
+            if (count == 0)
+            {
+                // Underrun: a fading track has nothing left worth waiting for
+                if (stopping)
+                    slot.gain = 0.0f;
+                break;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                slot.gain = stopping ? std::max(0.0f, slot.gain - step) : std::min(1.0f, slot.gain + step);
+                float gain = slot.gain * level;
+                const Sint16 *source = &slot.ring[((read + i) & (RING_FRAMES - 1)) * 2];
+                Sint16 *target = out + (done + i) * 2;
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    int sample = target[channel] + static_cast<int>(source[channel] * gain);
+                    target[channel] = static_cast<Sint16>(std::max(-32768, std::min(32767, sample)));
+                }
+            }
+            slot.readFrame.store(read + count, std::memory_order_release);
+            done += count;
+        }
+
+        bool drained = slot.ended.load(std::memory_order_acquire) &&
+                       slot.readFrame.load(std::memory_order_relaxed) == slot.writeFrame.load(std::memory_order_acquire);
+        if ((stopping && slot.gain <= 0.0f) || drained)
+        {
+            slot.gain = 0.0f;
+            slot.state.store(FINISHED, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "../managers/AssetBundle.h"
+#include <SDL2/SDL.h>
+#include <vorbis/vorbisfile.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Where a music track's Ogg Vorbis bytes come from
+struct MusicSource
+{
+    std::string path;                            // Loose file (full path)
+    const AssetBundle::Entry *bundled = nullptr; // Read from the bundle mapping instead when set
+};
+
+// Streams Ogg Vorbis music. A decoder thread keeps a fixed ring of converted
+// 16-bit stereo samples per track well ahead of the playhead; the audio backend
+// pulls from the rings with mix(), crossfading between tracks. Memory is the
+// rings plus decoder state, whatever the track length. Looping seeks the
+// decoder back to the start without draining the ring, so there is no gap.
+//
+// Threads: play/stop/volume from the main thread, mix() from the audio device
+// (or the offline mixer), decoding on the streamer's own thread. mix() never
+// locks unless blocking reads are enabled.
+class MusicStreamer
+{
+public:
+    static constexpr int SLOT_COUNT = 3;          // Current track plus tracks still fading out
+    static constexpr size_t RING_FRAMES = 65536;  // Per slot, ~1.5 s at 44.1 kHz (power of two)
+    static constexpr size_t REFILL_FRAMES = 4096; // Decoder tops a ring up once this much is free
+    static constexpr int DECODE_BUFFER_BYTES = 4096;
+
+private:
+    // Slot ownership moves FREE (main) -> REQUESTED (decoder opens and prefills)
+    // -> PLAYING (mixer reads) -> FINISHED (decoder closes) -> FREE
+    enum SlotState : int
+    {
+        FREE,
+        REQUESTED,
+        PLAYING,
+        FINISHED
+    };
+
+    struct Slot
+    {
+        std::atomic<int> state{FREE};
+
+        // Request, written by the main thread while FREE
+        MusicSource source;
+        bool loop = true;
+        std::atomic<float> fadeStep{1.0f};  // Gain change per output frame
+        std::atomic<bool> stopping{false};  // Fade out, then finish
+
+        // Decoder thread
+        OggVorbis_File file;
+        SDL_RWops *stream = nullptr;
+        SDL_AudioStream *converter = nullptr;
+        bool fileOpen = false;
+        bool flushed = false;           // Converter flushed at the end of the track
+        std::atomic<bool> ended{false}; // Everything has been written to the ring
+
+        // Ring of interleaved stereo frames: decoder writes, mixer reads
+        std::vector<Sint16> ring;
+        std::atomic<size_t> readFrame{0};
+        std::atomic<size_t> writeFrame{0};
+
+        // Mixer
+        float gain = 0.0f;
+    };
+    Slot slots[SLOT_COUNT];
+    std::vector<char> decodeBuffer; // Decoder thread
+    int outputFrequency;
+    std::atomic<int> volume{128}; // 0-128
+    std::atomic<bool> paused{false};
+    bool blockingReads = false;
+
+    std::thread decoder;
+    std::mutex mutex;
+    std::condition_variable wake;     // Main -> decoder: new request
+    std::condition_variable progress; // Decoder -> blocking readers: a pass finished
+    bool stopRequested = false;
+
+    void decoderLoop();
+    bool openSlot(Slot &slot);
+    void closeSlot(Slot &slot);
+    void fillSlot(Slot &slot);
+    bool hasPendingWork() const;
+
+public:
+    explicit MusicStreamer(int outputFrequency);
+    ~MusicStreamer();
+    MusicStreamer(const MusicStreamer &) = delete;
+    MusicStreamer &operator=(const MusicStreamer &) = delete;
+
+    // Whether a source can be opened and decoded (checked when music is loaded)
+    static bool probe(const MusicSource &source);
+
+    // Fade out whatever is playing and fade the new track in over fadeSeconds.
+    // False if every slot is still busy fading; the caller retries next frame.
+    bool play(const MusicSource &source, bool loop, float fadeSeconds);
+    void stop(float fadeSeconds);
+    void setVolume(int musicVolume) { volume.store(musicVolume, std::memory_order_relaxed); }
+    void setPaused(bool pause) { paused.store(pause, std::memory_order_relaxed); }
+    bool isPaused() const { return paused.load(std::memory_order_relaxed); }
+
+    // Offline mixing: wait for the decoder instead of underrunning, so the
+    // output doesn't depend on thread timing
+    void setBlockingReads(bool blocking) { blockingReads = blocking; }
+
+    // Fixed memory held for decoded samples, for reporting
+    size_t getBufferBytes() const { return SLOT_COUNT * RING_FRAMES * 2 * sizeof(Sint16); }
+
+    // Write `frames` frames of 16-bit stereo at the output frequency (overwrites out)
+    void mix(Sint16 *out, size_t frames);
+};
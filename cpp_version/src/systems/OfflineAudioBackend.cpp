@@ -0,0 +1,200 @@
+#include "OfflineAudioBackend.h"
+#include "MusicStreamer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+OfflineAudioBackend::OfflineAudioBackend(const std::string &dumpPath) : dumpPath(dumpPath) {}
+
+OfflineAudioBackend::~OfflineAudioBackend()
+{
+    close();
+}
+
+bool OfflineAudioBackend::open(int requestedFrequency, int chunkSize)
+{
+    // The dummy driver needs no hardware; it only gives SDL_mixer a format to decode into
+    SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+    if (Mix_OpenAudio(requestedFrequency, AUDIO_S16SYS, 2, chunkSize) < 0)
+    {
+        std::cerr << "SDL_mixer could not initialize on the dummy driver! SDL_mixer Error: " << Mix_GetError()
+                  << std::endl;
+        return false;
+    }
+
+    Uint16 format = 0;
+    int channels = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    if (format != AUDIO_S16SYS || channels != 2)
+    {
+        std::cerr << "Offline mixer needs 16-bit stereo, got format 0x" << std::hex << format << std::dec
+                  << " with " << channels << " channels" << std::endl;
+        Mix_CloseAudio();
+        return false;
+    }
+
+    if (!dumpPath.empty())
+    {
+        dumpFile.open(dumpPath, std::ios::binary | std::ios::trunc);
+        if (!dumpFile)
+        {
+            std::cerr << "Failed to create audio dump: " << dumpPath << std::endl;
+        }
+        else
+        {
+            writeWavHeader(); // Sizes are patched on close
+        }
+    }
+    return true;
+}
+
+void OfflineAudioBackend::close()
+{
+    if (dumpFile.is_open())
+    {
+        dumpFile.seekp(0);
+        writeWavHeader();
+        dumpFile.close();
+    }
+    if (frequency > 0)
+    {
+        Mix_CloseAudio();
+        frequency = 0;
+    }
+    voices.clear();
+    music = nullptr;
+}
+
+void OfflineAudioBackend::writeWavHeader()
+{
+    auto write32 = [this](Uint32 value) {
+        Uint8 bytes[4] = {static_cast<Uint8>(value), static_cast<Uint8>(value >> 8),
+                          static_cast<Uint8>(value >> 16), static_cast<Uint8>(value >> 24)};
+        dumpFile.write(reinterpret_cast<const char *>(bytes), 4);
+    };
+    auto write16 = [this](Uint16 value) {
+        Uint8 bytes[2] = {static_cast<Uint8>(value), static_cast<Uint8>(value >> 8)};
+        dumpFile.write(reinterpret_cast<const char *>(bytes), 2);
+    };
+
+    Uint32 dataSize = static_cast<Uint32>(std::min<Uint64>(dumpBytes, 0xFFFFFFFFu - 36));
+    dumpFile.write("RIFF", 4);
+    write32(36 + dataSize);
+    dumpFile.write("WAVEfmt ", 8);
+    write32(16);                               // fmt chunk size
+    write16(1);                                // PCM
+    write16(2);                                // Channels
+    write32(static_cast<Uint32>(frequency));
+    write32(static_cast<Uint32>(frequency) * 4); // Bytes per second
+    write16(4);                                // Bytes per frame
+    write16(16);                               // Bits per sample
+    dumpFile.write("data", 4);
+    write32(dataSize);
+}
+
+void OfflineAudioBackend::allocateVoices(int count)
+{
+    voices.assign(count, VoiceState());
+}
+
+bool OfflineAudioBackend::startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right)
+{
+    if (voice < 0 || voice >= static_cast<int>(voices.size()) || !chunk)
+        return false;
+
+    // Chunks were decoded by SDL_mixer into the 16-bit stereo output format
+    VoiceState &state = voices[voice];
+    state.samples = reinterpret_cast<const Sint16 *>(chunk->abuf);
+    state.frameCount = chunk->alen / 4;
+    state.position = 0;
+    state.leftGain = volume * left;
+    state.rightGain = volume * right;
+    return true;
+}
+
+void OfflineAudioBackend::haltVoice(int voice)
+{
+    if (voice < 0)
+    {
+        for (VoiceState &state : voices)
+            state = VoiceState();
+    }
+    else if (voice < static_cast<int>(voices.size()))
+    {
+        voices[voice] = VoiceState();
+    }
+}
+
+bool OfflineAudioBackend::isVoicePlaying(int voice) const
+{
+    return voice >= 0 && voice < static_cast<int>(voices.size()) && voices[voice].samples != nullptr;
+}
+
+bool OfflineAudioBackend::setMusicSource(MusicStreamer *source)
+{
+    music = source;
+    if (music)
+        music->setBlockingReads(true);
+    return true;
+}
+
+void OfflineAudioBackend::advance(float seconds)
+{
+    if (frequency <= 0)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    pendingFrames += static_cast<double>(seconds) * frequency;
+    size_t frames = static_cast<size_t>(pendingFrames);
+    pendingFrames -= static_cast<double>(frames);
+
+    accumulator.assign(frames * 2, 0);
+    for (VoiceState &state : voices)
+    {
+        if (!state.samples)
+            continue;
+
+        // 16-bit sample * 128 volume * 255 pan stays well inside 32 bits
+        size_t count = std::min<size_t>(frames, state.frameCount - state.position);
+        const Sint16 *source = state.samples + static_cast<size_t>(state.position) * 2;
+        for (size_t i = 0; i < count; ++i)
+        {
+            accumulator[i * 2] += source[i * 2] * state.leftGain / (MIX_MAX_VOLUME * 255);
+            accumulator[i * 2 + 1] += source[i * 2 + 1] * state.rightGain / (MIX_MAX_VOLUME * 255);
+        }
+
+        state.position += static_cast<Uint32>(count);
+        if (state.position >= state.frameCount)
+            state = VoiceState();
+    }
+
+    if (music)
+    {
+        musicBlock.resize(frames * 2);
+        music->mix(musicBlock.data(), frames);
+        for (size_t i = 0; i < musicBlock.size(); ++i)
+            accumulator[i] += musicBlock[i];
+    }
+
+    block.resize(accumulator.size());
+    for (size_t i = 0; i < accumulator.size(); ++i)
+    {
+        Sint32 sample = std::max(-32768, std::min(32767, accumulator[i]));
+        block[i] = static_cast<Sint16>(sample);
+        peak = std::max(peak, std::abs(sample));
+        checksum = (checksum ^ static_cast<Uint16>(sample)) * 1099511628211ULL;
+    }
+    framesMixed += frames;
+
+    mixCpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Samples are written in native order (all supported platforms are little-endian)
+    if (dumpFile.is_open() && !block.empty())
+    {
+        dumpFile.write(reinterpret_cast<const char *>(block.data()),
+                       static_cast<std::streamsize>(block.size() * sizeof(Sint16)));
+        dumpBytes += block.size() * sizeof(Sint16);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "AudioBackend.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Software mixer that renders sound effects and music into memory instead of a device.
+// Each game frame mixes exactly that frame's worth of samples, so output is
+// driven by the game loop: a headless run mixes faster than real time and two
+// runs with the same input produce the same samples (and checksum).
+//
+// SDL_mixer is opened on SDL's dummy driver only to decode sounds into the
+// output format; it never plays them. Music reads block on the streamer's
+// decoder rather than underrunning.
+class OfflineAudioBackend : public AudioBackend
+{
+private:
+    struct VoiceState
+    {
+        const Sint16 *samples = nullptr; // Interleaved stereo; nullptr = idle
+        Uint32 frameCount = 0;
+        Uint32 position = 0;
+        int leftGain = 0;  // volume * left pan (0-128 * 0-255)
+        int rightGain = 0;
+    };
+    std::vector<VoiceState> voices;
+
+    int frequency = 0;
+    double pendingFrames = 0.0;        // Fraction of a sample frame carried to the next game frame
+    std::vector<Sint32> accumulator;   // One frame's mix before clamping
+    std::vector<Sint16> block;         // One frame's output, interleaved stereo
+    std::vector<Sint16> musicBlock;    // One frame of streamed music
+
+    MusicStreamer *music = nullptr;
+
+    // Totals since open
+    Uint64 framesMixed = 0;
+    Uint64 checksum = 1469598103934665603ULL; // FNV-1a over the output samples
+    int peak = 0;
+    double mixCpuSeconds = 0.0;
+
+    // Optional WAV capture of the whole run
+    std::string dumpPath;
+    std::ofstream dumpFile;
+    Uint64 dumpBytes = 0;
+
+    void writeWavHeader();
+
+public:
+    explicit OfflineAudioBackend(const std::string &dumpPath = "");
+    ~OfflineAudioBackend();
+
+    bool open(int frequency, int chunkSize) override;
+    void close() override;
+
+    void allocateVoices(int count) override;
+    bool startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right) override;
+    void haltVoice(int voice) override;
+    bool isVoicePlaying(int voice) const override;
+
+    bool setMusicSource(MusicStreamer *source) override;
+
+    // Mix the next `seconds` of output
+    void advance(float seconds) override;
+
+    const char *getName() const override { return "offline"; }
+
+    // Output of the last advance() and run totals
+    const std::vector<Sint16> &getLastBlock() const { return block; }
+    double getMixedSeconds() const { return frequency > 0 ? static_cast<double>(framesMixed) / frequency : 0.0; }
+    double getMixCpuSeconds() const { return mixCpuSeconds; }
+    Uint64 getChecksum() const { return checksum; }
+    int getPeak() const { return peak; }
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "RenderQueue.h"
+#include <SDL2/SDL.h>
+
+// Destination for a frame's sorted draw commands. RenderSystem generates the
+// commands; a backend turns them into pixels on the GPU or the CPU.
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // Start a frame by clearing the target
+    virtual void beginFrame(SDL_Color clearColor) = 0;
+
+    // Draw a sorted command queue on top of the current frame
+    virtual void submit(const RenderQueue &queue) = 0;
+
+    // Draw the world submissions between these calls at a fraction of native
+    // resolution and upscale them to the frame on endScaledPass. Backends
+    // without offscreen targets draw at native resolution.
+    virtual void beginScaledPass(float scale, SDL_Color clearColor) {}
+    virtual void endScaledPass() {}
+
+    // Render targets were reset (contents lost) or the whole device was lost
+    // (textures unusable); drop anything the backend keeps on the renderer
+    virtual void invalidate(bool deviceLost) {}
+
+    // Finish the frame (present, dump, ...)
+    virtual void endFrame() = 0;
+
+    // Whether SDL render-target textures show up in this backend's output
+    virtual bool supportsRenderTargets() const = 0;
+
+    virtual const char *getName() const = 0;
+};
@@ -0,0 +1,130 @@
+#include "RenderQueue.h"
+#include <utility>
+
+void RenderQueue::clear()
+{
+    // Keep capacity so steady-state frames don't allocate
+    commands.clear();
+    textures.clear();
+}
+
+void RenderQueue::push(RenderLayer layer, SDL_Texture *texture, const SDL_FRect &dest,
+                       float u0, float v0, float u1, float v1,
+                       SDL_RendererFlip flip, SDL_Color color)
+{
+    DrawCommand command;
+    command.textureKey = getTextureKey(texture);
+    command.layer = layer;
+    command.flip = static_cast<Uint8>(flip);
+    command.sortKey = (static_cast<Uint32>(layer) << 16) | command.textureKey;
+    command.dest = dest;
+    command.u0 = u0;
+    command.v0 = v0;
+    command.u1 = u1;
+    command.v1 = v1;
+    command.color = color;
+    commands.push_back(command);
+}
+
+Uint16 RenderQueue::getTextureKey(SDL_Texture *texture)
+{
+    // Only a handful of atlas pages per frame, and consecutive pushes usually repeat
+    if (!textures.empty() && textures.back() == texture)
+        return static_cast<Uint16>(textures.size() - 1);
+
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        if (textures[i] == texture)
+            return static_cast<Uint16>(i);
+    }
+
+    textures.push_back(texture);
+    return static_cast<Uint16>(textures.size() - 1);
+}
+
+void RenderQueue::sort()
+{
+    if (commands.size() < 2)
+        return;
+
+    scratch.resize(commands.size());
+
+    // Three 8-bit passes cover layer (8 bits) and texture key (16 bits)
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        size_t counts[256] = {};
+        for (const auto &command : commands)
+        {
+            counts[(command.sortKey >> shift) & 0xFF]++;
+        }
+
+        // Skip the pass when every command lands in the same bucket
+        if (counts[(commands[0].sortKey >> shift) & 0xFF] == commands.size())
+            continue;
+
+        size_t offset = 0;
+        for (auto &count : counts)
+        {
+            size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (const auto &command : commands)
+        {
+            scratch[counts[(command.sortKey >> shift) & 0xFF]++] = command;
+        }
+        commands.swap(scratch);
+    }
+}
+
+void RenderQueue::submit(SDL_Renderer *renderer) const
+{
+    lastBatchCount = 0;
+    size_t runStart = 0;
+
+    while (runStart < commands.size())
+    {
+        Uint32 runKey = commands[runStart].sortKey;
+        vertices.clear();
+        indices.clear();
+
+        size_t i = runStart;
+        for (; i < commands.size() && commands[i].sortKey == runKey; ++i)
+        {
+            const DrawCommand &command = commands[i];
+
+            // Flipping is just swapping texture coordinates
+            float u0 = command.u0, u1 = command.u1;
+            float v0 = command.v0, v1 = command.v1;
+            if (command.flip & SDL_FLIP_HORIZONTAL)
+                std::swap(u0, u1);
+            if (command.flip & SDL_FLIP_VERTICAL)
+                std::swap(v0, v1);
+
+            float x0 = command.dest.x;
+            float y0 = command.dest.y;
+            float x1 = x0 + command.dest.w;
+            float y1 = y0 + command.dest.h;
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({{x0, y0}, command.color, {u0, v0}});
+            vertices.push_back({{x1, y0}, command.color, {u1, v0}});
+            vertices.push_back({{x1, y1}, command.color, {u1, v1}});
+            vertices.push_back({{x0, y1}, command.color, {u0, v1}});
+
+            indices.push_back(base + 0);
+            indices.push_back(base + 1);
+            indices.push_back(base + 2);
+            indices.push_back(base + 0);
+            indices.push_back(base + 2);
+            indices.push_back(base + 3);
+        }
+
+        SDL_RenderGeometry(renderer, textures[commands[runStart].textureKey],
+                           vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+        lastBatchCount++;
+        runStart = i;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <type_traits>
+#include <vector>
+
+// Draw order buckets; lower layers are submitted first
+enum RenderLayer : Uint8
+{
+    LAYER_WORLD = 0,
+    LAYER_UI = 1
+};
+
+// Compact POD draw command for one textured quad
+struct DrawCommand
+{
+    Uint32 sortKey;    // layer << 16 | textureKey, filled in by RenderQueue::push
+    Uint16 textureKey; // Index into the queue's per-frame texture table
+    Uint8 layer;
+    Uint8 flip;        // SDL_RendererFlip bits, applied to the UVs at submission
+    SDL_FRect dest;
+    float u0, v0, u1, v1;
+    SDL_Color color;
+};
+static_assert(std::is_trivially_copyable<DrawCommand>::value, "DrawCommand must stay POD");
+
+// Frame command buffer: commands are generated first, radix-sorted by
+// (layer, texture) and then submitted as one SDL_RenderGeometry per run.
+// Generation touches no SDL state, so only submit() has to run on the
+// thread that owns the renderer.
+class RenderQueue
+{
+private:
+    std::vector<DrawCommand> commands;
+    std::vector<DrawCommand> scratch;
+    std::vector<SDL_Texture *> textures;
+
+    // Submission buffers, kept between frames to avoid allocation
+    mutable std::vector<SDL_Vertex> vertices;
+    mutable std::vector<int> indices;
+
+    mutable size_t lastBatchCount = 0;
+
+public:
+    void clear();
+
+    void push(RenderLayer layer, SDL_Texture *texture, const SDL_FRect &dest,
+              float u0, float v0, float u1, float v1,
+              SDL_RendererFlip flip = SDL_FLIP_NONE,
+              SDL_Color color = {255, 255, 255, 255});
+
+    // Stable LSD radix sort on sortKey; submission order is kept within a (layer, texture) run
+    void sort();
+
+    // Submit sorted commands, one draw call per run of identical texture
+    void submit(SDL_Renderer *renderer) const;
+
+    const std::vector<DrawCommand> &getCommands() const { return commands; }
+    SDL_Texture *getTexture(Uint16 key) const { return textures[key]; }
+    size_t getLastBatchCount() const { return lastBatchCount; }
+
+private:
+    Uint16 getTextureKey(SDL_Texture *texture);
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "RenderQueue.h"
+#include "../core/ECS.h"
+#include "../components/Components.h"
+#include <atomic>
+#include <vector>
+
+// UI text element as seen by the renderer for one frame
+struct UITextSnapshot
+{
+    EntityID entityID;
+    UIText text;
+    float x, y;
+    int wrapWidth; // 0 = single line
+    bool centered; // Block is centered on (x, y) instead of starting there
+};
+
+// Immutable view of everything the render stage needs for one frame.
+// Built by the simulation without touching SDL, consumed by the thread
+// that owns the renderer.
+struct RenderSnapshot
+{
+    RenderQueue worldQueue;                // Sorted sprite draw commands
+    std::vector<UITextSnapshot> uiTexts;   // Reused between frames to keep string capacity
+    size_t uiTextCount = 0;                // Live entries in uiTexts
+    Uint32 spritesDrawn = 0;               // Sprites inside the view rectangle
+    Uint32 spritesCulled = 0;              // Sprites skipped by viewport culling
+    Uint64 frameNumber = 0;                // Simulation frame this snapshot was taken on
+    Uint64 contentHash = 0;                // Equal hashes mean the frame would look the same
+    bool sceneStatic = false;              // Nothing on screen moves by itself (menus)
+};
+
+// Triple buffer of render snapshots: the simulation always has a slot to
+// write into, the renderer always reads the most recently published one,
+// and neither side ever waits for the other.
+class SnapshotRing
+{
+private:
+    static constexpr int FRESH_BIT = 4;
+    static constexpr int INDEX_MASK = 3;
+
+    RenderSnapshot buffers[3];
+    int writeIndex = 0;
+    int readIndex = 2;
+    std::atomic<int> readyIndex{1};
+    bool published = false; // Set once the first snapshot is out (render side only)
+
+public:
+    // Simulation side
+    RenderSnapshot &beginWrite() { return buffers[writeIndex]; }
+    void publish()
+    {
+        int previous = readyIndex.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Render side: latest snapshot, or the previous one again if nothing new was published.
+    // Returns nullptr until the simulation has published a first snapshot.
+    const RenderSnapshot *acquireLatest(bool *isFresh = nullptr)
+    {
+        bool fresh = (readyIndex.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+        if (fresh)
+        {
+            int previous = readyIndex.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+            published = true;
+        }
+        if (isFresh)
+            *isFresh = fresh;
+        return published ? &buffers[readIndex] : nullptr;
+    }
+};
@@ -1,238 +1,506 @@
 #include "RenderSystem.h"
 #include "../components/Components.h"
 #include "../managers/ResourceManager.h"
+#include "../core/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 #include <sstream>
 
-RenderSystem::RenderSystem(SDL_Renderer *renderer, ResourceManager *rm)
-    : renderer(renderer), resourceManager(rm) {}
+namespace
+{
+    // FNV-1a, enough to tell whether two frames would draw the same thing
+    constexpr Uint64 FNV_OFFSET = 14695981039346656037ull;
+    constexpr Uint64 FNV_PRIME = 1099511628211ull;
+
+    Uint64 hashBytes(Uint64 hash, const void *data, size_t size)
+    {
+        const Uint8 *bytes = static_cast<const Uint8 *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * FNV_PRIME;
+        }
+        return hash;
+    }
+    static_assert(sizeof(DrawCommand) == 44, "hashSnapshot hashes DrawCommand bytes, so it must have no padding");
+}
+
+RenderSystem::RenderSystem(SDL_Renderer *renderer, ResourceManager *rm, std::unique_ptr<RenderBackend> backend)
+    : renderer(renderer), resourceManager(rm), backend(std::move(backend)) {}
 
-void RenderSystem::update(ECS &ecs, GameManager &gameManager, float fps)
+RenderSystem::~RenderSystem()
 {
-    // Clear screen with sky blue background (135, 206, 235)
-    SDL_SetRenderDrawColor(renderer, 135, 206, 235, 255);
-    SDL_RenderClear(renderer);
+    for (auto &[entityID, cache] : textCaches)
+    {
+        if (cache.texture)
+            SDL_DestroyTexture(cache.texture);
+    }
+    textCaches.clear();
+}
+
+void RenderSystem::buildSnapshot(ECS &ecs, RenderSnapshot &snapshot, const Camera &camera, float alpha)
+{
+    // Follow the target where it is drawn this frame, not where the last tick left it
+    Camera view = camera;
+    if (auto *target = ecs.getComponent<Transform>(camera.getTarget()))
+    {
+        float x, y;
+        interpolatePosition(ecs, camera.getTarget(), *target, alpha, x, y);
+        view.centerOn(x, y);
+    }
+    viewRect = view.getView();
+
+    // World draw commands are generated and sorted here, off the render thread
+    snapshot.worldQueue.clear();
+    {
+        PROFILE_ZONE("Snapshot sprites");
+        snapshotSprites(ecs, snapshot, alpha);
+    }
+    {
+        PROFILE_ZONE("Sort draw commands");
+        snapshot.worldQueue.sort();
+    }
 
-    // Render game sprites
-    renderSprites(ecs);
+    snapshotUI(ecs, snapshot);
+    PROFILE_ZONE("Hash snapshot");
+    snapshot.contentHash = hashSnapshot(snapshot);
+}
+
+Uint64 RenderSystem::hashSnapshot(const RenderSnapshot &snapshot)
+{
+    // DrawCommand is padding-free POD; texture keys are resolved so the hash
+    // does not depend on which ring buffer the snapshot lives in
+    Uint64 hash = FNV_OFFSET;
+    const auto &commands = snapshot.worldQueue.getCommands();
+    for (const DrawCommand &command : commands)
+    {
+        SDL_Texture *texture = snapshot.worldQueue.getTexture(command.textureKey);
+        hash = hashBytes(hash, &texture, sizeof(texture));
+        hash = hashBytes(hash, &command, sizeof(command));
+    }
 
-    // Render UI
-    renderUI(ecs, gameManager, fps);
+    for (size_t i = 0; i < snapshot.uiTextCount; ++i)
+    {
+        const UITextSnapshot &entry = snapshot.uiTexts[i];
+        const UIText &text = entry.text;
+        hash = hashBytes(hash, &entry.entityID, sizeof(entry.entityID));
+        hash = hashBytes(hash, text.content.data(), text.content.size());
+        hash = hashBytes(hash, &text.font.index, sizeof(text.font.index));
+        hash = hashBytes(hash, &text.color, sizeof(text.color));
+        hash = hashBytes(hash, &text.visible, sizeof(text.visible));
+        hash = hashBytes(hash, &entry.x, sizeof(entry.x));
+        hash = hashBytes(hash, &entry.y, sizeof(entry.y));
+    }
 
-    // Present frame
-    SDL_RenderPresent(renderer);
+    return hash;
 }
 
-void RenderSystem::renderSprites(ECS &ecs)
+void RenderSystem::renderSnapshot(const RenderSnapshot &snapshot)
 {
-    auto &transforms = ecs.getComponents<Transform>();
+    // UI text may compose off-screen, so it is laid out on the render side
+    uiQueue.clear();
+    {
+        PROFILE_ZONE("Lay out UI");
+        renderUI(snapshot);
+        uiQueue.sort();
+    }
+
+    // Clear screen with sky blue background (135, 206, 235), draw world (possibly at
+    // reduced resolution) then UI at native resolution, and present
+    const SDL_Color skyBlue = {135, 206, 235, 255};
+    backend->beginFrame(skyBlue);
+    {
+        PROFILE_ZONE("Submit draw commands");
+        backend->beginScaledPass(resolution.scale, skyBlue);
+        backend->submit(snapshot.worldQueue);
+        backend->endScaledPass();
+        backend->submit(uiQueue);
+    }
 
+    // Present can block on vsync; that time is not render work
+    PROFILE_ZONE("Present");
+    auto presentStart = std::chrono::steady_clock::now();
+    backend->endFrame();
+    lastPresentTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - presentStart).count();
+}
+
+void RenderSystem::configureResolutionScaling(bool enabled, float minScale, float step)
+{
+    resolution.enabled = enabled;
+    resolution.minScale = std::clamp(minScale, 0.25f, 1.0f);
+    resolution.step = std::clamp(step, 0.01f, 0.5f);
+    resolution.scale = 1.0f;
+}
+
+void RenderSystem::reportFrameTime(float workSeconds, float budgetSeconds)
+{
+    // Unlocked pacing has no budget to chase
+    if (!resolution.enabled || budgetSeconds <= 0.0f)
+        return;
+
+    const float SMOOTHING = 0.1f;
+    const float DOWN_THRESHOLD = 0.9f; // Drop resolution above 90% of budget...
+    const float UP_THRESHOLD = 0.6f;   // ...and only raise it again below 60%
+    const int DOWN_FRAMES = 10;        // React to overload quickly
+    const int UP_FRAMES = 120;         // Recover slowly so the scale doesn't oscillate
+    const int COOLDOWN_FRAMES = 30;
+
+    resolution.averageWorkTime += (workSeconds - resolution.averageWorkTime) * SMOOTHING;
+    if (resolution.cooldownFrames > 0)
+    {
+        resolution.cooldownFrames--;
+        return;
+    }
+
+    float load = resolution.averageWorkTime / budgetSeconds;
+    resolution.framesOverBudget = load > DOWN_THRESHOLD ? resolution.framesOverBudget + 1 : 0;
+    resolution.framesUnderBudget = load < UP_THRESHOLD ? resolution.framesUnderBudget + 1 : 0;
+
+    float newScale = resolution.scale;
+    if (resolution.framesOverBudget >= DOWN_FRAMES)
+        newScale = std::max(resolution.minScale, resolution.scale - resolution.step);
+    else if (resolution.framesUnderBudget >= UP_FRAMES)
+        newScale = std::min(1.0f, resolution.scale + resolution.step);
+
+    if (newScale != resolution.scale)
+    {
+        resolution.scale = newScale;
+        resolution.framesOverBudget = 0;
+        resolution.framesUnderBudget = 0;
+        resolution.cooldownFrames = COOLDOWN_FRAMES;
+        std::cout << "World resolution scale: " << static_cast<int>(newScale * 100.0f + 0.5f)
+                  << "% (frame work " << resolution.averageWorkTime * 1000.0f << " ms)" << std::endl;
+    }
+}
+
+void RenderSystem::interpolatePosition(ECS &ecs, EntityID entityID, const Transform &transform, float alpha,
+                                       float &x, float &y)
+{
+    // Draw between the previous and current tick positions
+    x = transform.x;
+    y = transform.y;
+    if (auto *previous = ecs.getComponent<PreviousTransform>(entityID))
+    {
+        x = previous->x + (transform.x - previous->x) * alpha;
+        y = previous->y + (transform.y - previous->y) * alpha;
+    }
+}
+
+void RenderSystem::snapshotSprites(ECS &ecs, RenderSnapshot &snapshot, float alpha)
+{
+    RenderQueue &queue = snapshot.worldQueue;
+
+    // Index sprite bounds, then only do per-sprite work for what the view rectangle touches
+    spriteGrid.clear();
+    auto &transforms = ecs.getComponents<Transform>();
     for (auto &[entityID, transform] : transforms)
     {
+        auto *sprite = ecs.getComponent<Sprite>(entityID);
+        if (!sprite)
+            continue;
+
+        float x, y;
+        interpolatePosition(ecs, entityID, transform, alpha, x, y);
+        spriteGrid.insert(entityID, x, y, sprite->width / 2.0f, sprite->height / 2.0f);
+    }
+
+    visibleEntities.clear();
+    spriteGrid.query(viewRect, visibleEntities);
+    snapshot.spritesDrawn = static_cast<Uint32>(visibleEntities.size());
+    snapshot.spritesCulled = static_cast<Uint32>(spriteGrid.size() - visibleEntities.size());
+
+    for (EntityID entityID : visibleEntities)
+    {
+        auto *transform = ecs.getComponent<Transform>(entityID);
         auto *sprite = ecs.getComponent<Sprite>(entityID);
         auto *animation = ecs.getComponent<Animation>(entityID);
-        auto *entityType = ecs.getComponent<EntityType>(entityID);
+        auto *movementDir = ecs.getComponent<MovementDirection>(entityID);
+        auto *velocity = ecs.getComponent<Velocity>(entityID);
 
-        if (sprite)
-        {
-            std::string texturePath;
-            bool needsTextureReload = false;
+        float x, y;
+        interpolatePosition(ecs, entityID, *transform, alpha, x, y);
 
-            // Determine texture path based on entity type
-            if (entityType && entityType->type == "player")
+        // World to screen, with the camera snapped to whole pixels so sprites don't shimmer
+        x -= std::floor(viewRect.x);
+        y -= std::floor(viewRect.y);
+
+        SDL_Rect destRect = {
+            static_cast<int>(x - sprite->width / 2),
+            static_cast<int>(y - sprite->height / 2),
+            sprite->width,
+            sprite->height};
+
+        // Look up the precomputed clip for this sprite type and facing
+        int direction = movementDir ? movementDir->direction : MovementDirection::HORIZONTAL;
+        const SpriteClip *clip = resourceManager->getSpriteClip(sprite->spriteTypeId, direction);
+
+        if (clip)
+        {
+            int frame = 0;
+            if (animation && sprite->animated)
             {
-                // For player entities, check movement direction and animation frame
-                auto *movementDir = ecs.getComponent<MovementDirection>(entityID);
-                auto *velocity = ecs.getComponent<Velocity>(entityID);
-                int frameNumber = 1; // Default to frame 1
-
-                // Get current animation frame
-                if (animation && sprite->animated && sprite->frameCount > 1)
-                {
-                    frameNumber = (animation->currentFrame % sprite->frameCount) + 1;
-                }
-
-                if (movementDir && movementDir->direction == MovementDirection::VERTICAL)
-                {
-                    texturePath = "art/playerGrey_up" + std::to_string(frameNumber) + ".png";
-                }
-                else
-                {
-                    texturePath = "art/playerGrey_walk" + std::to_string(frameNumber) + ".png";
-                }
-
-                // Always reload texture for player to handle animation and direction changes
-                needsTextureReload = true;
+                frame = animation->currentFrame % clip->frameCount;
             }
-            else if (entityType && (entityType->type == "flying" || entityType->type == "swimming" || entityType->type == "walking"))
-            {
-                // For mob entities, handle individual frame files and direction
-                int frameNumber = 1; // Default to frame 1
-
-                // Get current animation frame
-                if (animation && sprite->animated && sprite->frameCount > 1)
-                {
-                    frameNumber = (animation->currentFrame % sprite->frameCount) + 1;
-                }
-
-                if (entityType->type == "flying")
-                {
-                    texturePath = "art/enemyFlyingAlt_" + std::to_string(frameNumber) + ".png";
-                }
-                else if (entityType->type == "swimming")
-                {
-                    texturePath = "art/enemySwimming_" + std::to_string(frameNumber) + ".png";
-                }
-                else if (entityType->type == "walking")
-                {
-                    texturePath = "art/enemyWalking_" + std::to_string(frameNumber) + ".png";
-                }
-
-                // Always reload texture to handle animation changes
-                needsTextureReload = true;
-            } // Load or reload texture if needed
-            if (needsTextureReload && !texturePath.empty())
+            const AtlasRegion &region = resourceManager->getClipFrame(*clip, frame);
+            if (region.source.isValid())
+                resourceManager->useTexture(region.source); // Keeps standalone frames resident
+            if (!region.texture)
+                continue; // Standalone frame still streaming in
+
+            // Mirror based on velocity along the clip's axis
+            SDL_RendererFlip flipFlags = SDL_FLIP_NONE;
+            if (velocity)
             {
-                sprite->texture = resourceManager->loadTexture(texturePath);
-                sprite->currentTexturePath = texturePath;
+                float axisVelocity = direction == MovementDirection::VERTICAL ? velocity->y : velocity->x;
+                if (axisVelocity < 0)
+                    flipFlags = clip->flipWhenNegative;
+                else if (axisVelocity > 0)
+                    flipFlags = clip->flipWhenPositive;
             }
 
-            if (sprite->texture)
-            {
-                // Get the actual texture dimensions
-                int textureWidth, textureHeight;
-                SDL_QueryTexture(sprite->texture, nullptr, nullptr, &textureWidth, &textureHeight);
-
-                SDL_Rect destRect = {
-                    static_cast<int>(transform.x - sprite->width / 2),
-                    static_cast<int>(transform.y - sprite->height / 2),
-                    sprite->width,
-                    sprite->height};
-
-                // Source rectangle should use the full texture
-                // (all sprites are individual frame files, not sprite sheets)
-                SDL_Rect srcRect = {0, 0, textureWidth, textureHeight};
-
-                // Determine sprite flipping based on entity type and movement direction
-                SDL_RendererFlip flipFlags = SDL_FLIP_NONE;
-                auto *velocity = ecs.getComponent<Velocity>(entityID);
-
-                if (entityType && entityType->type == "player" && velocity)
-                {
-                    // Flip player sprite vertically when moving down
-                    auto *movementDir = ecs.getComponent<MovementDirection>(entityID);
-                    if (movementDir && movementDir->direction == MovementDirection::VERTICAL && velocity->y > 0)
-                    {
-                        flipFlags = SDL_FLIP_VERTICAL;
-                    }
-                }
-                else if (entityType && (entityType->type == "flying" || entityType->type == "swimming" || entityType->type == "walking") && velocity)
-                {
-                    // Flip mob sprites based on movement direction
-                    auto *movementDir = ecs.getComponent<MovementDirection>(entityID);
-                    if (movementDir)
-                    {
-                        if (movementDir->direction == MovementDirection::HORIZONTAL && velocity->x < 0)
-                        {
-                            flipFlags = SDL_FLIP_HORIZONTAL; // Flip when moving left (since sprites face right by default)
-                        }
-                        else if (movementDir->direction == MovementDirection::VERTICAL)
-                        {
-                            if (velocity->y < 0)
-                            {
-                                flipFlags = SDL_FLIP_VERTICAL; // Flip when moving up
-                            }
-                            // When moving down (velocity->y > 0), use normal orientation (no flip)
-                        }
-                    }
-                }
-
-                SDL_RenderCopyEx(renderer, sprite->texture, &srcRect, &destRect, 0.0, nullptr, flipFlags);
-            }
+            // Frames are batched per atlas page at submission
+            queue.push(LAYER_WORLD, region.texture, toFRect(destRect),
+                       region.u0, region.v0, region.u1, region.v1, flipFlags);
+        }
+        else if (SDL_Texture *texture = resourceManager->useTexture(sprite->texture))
+        {
+            // Static sprite without a clip: the whole texture is the frame
+            queue.push(LAYER_WORLD, texture, toFRect(destRect), 0.0f, 0.0f, 1.0f, 1.0f);
         }
     }
 }
 
-void RenderSystem::renderUI(ECS &ecs, GameManager &gameManager, float fps)
+void RenderSystem::queueText(RenderQueue &queue, const GlyphAtlas &glyphs, const std::string &text,
+                             int x, int y, SDL_Color color)
 {
+    int penX = x;
+    char previous = 0;
+    for (char c : text)
+    {
+        penX += glyphs.getKerning(previous, c);
+        const GlyphInfo *glyph = glyphs.getGlyph(c);
+        if (glyph->rect.w > 0)
+        {
+            SDL_FRect dest = {static_cast<float>(penX), static_cast<float>(y),
+                              static_cast<float>(glyph->rect.w), static_cast<float>(glyph->rect.h)};
+            queue.push(LAYER_UI, glyphs.texture, dest, glyph->u0, glyph->v0, glyph->u1, glyph->v1,
+                       SDL_FLIP_NONE, color);
+        }
+        penX += glyph->advance;
+        previous = c;
+    }
+}
+
+void RenderSystem::snapshotUI(ECS &ecs, RenderSnapshot &snapshot)
+{
+    // Hidden text is captured too so its cache survives until it is shown again
+    snapshot.uiTextCount = 0;
     auto &uiPositions = ecs.getComponents<UIPosition>();
 
     for (auto &[entityID, uiPos] : uiPositions)
     {
         auto *uiText = ecs.getComponent<UIText>(entityID);
-        if (!uiText || !uiText->visible)
+        if (!uiText)
+            continue;
+
+        if (snapshot.uiTextCount == snapshot.uiTexts.size())
+            snapshot.uiTexts.emplace_back();
+        UITextSnapshot &entry = snapshot.uiTexts[snapshot.uiTextCount++];
+
+        // Game message is wrapped and centered on its position
+        auto *entityType = ecs.getComponent<EntityType>(entityID);
+        entry.centered = entityType && entityType->id == centeredTextType;
+        entry.wrapWidth = entry.centered ? CENTERED_TEXT_WRAP_WIDTH : 0;
+
+        entry.entityID = entityID;
+        entry.text = *uiText; // Assignment reuses the entry's string capacity
+        entry.x = uiPos.x;
+        entry.y = uiPos.y;
+    }
+}
+
+void RenderSystem::renderUI(const RenderSnapshot &snapshot)
+{
+    pruneTextCaches(snapshot);
+
+    for (size_t i = 0; i < snapshot.uiTextCount; ++i)
+    {
+        const UITextSnapshot &entry = snapshot.uiTexts[i];
+        if (!entry.text.visible)
+            continue;
+
+        // Glyphs are rasterised once per (font, size); text is just quads from here on
+        const GlyphAtlas *glyphs = resourceManager->getGlyphAtlas(entry.text.font);
+        if (!glyphs)
             continue;
 
-        // Load font if not already loaded
-        TTF_Font *font = resourceManager->getFont(uiText->fontPath, uiText->fontSize);
-        if (!font)
+        TextCache &cache = updateTextCache(entry.entityID, entry.text, *glyphs, entry.wrapWidth);
+
+        int x = static_cast<int>(entry.x);
+        int y = static_cast<int>(entry.y);
+        if (entry.centered)
         {
-            font = resourceManager->loadFont(uiText->fontPath, uiText->fontSize);
+            x = static_cast<int>(entry.x - cache.width / 2);
+            y = static_cast<int>(entry.y - cache.height / 2.0f);
         }
 
-        if (font)
+        if (backend->supportsRenderTargets() && (cache.composed || composeTextTexture(cache, *glyphs)))
         {
-            // Check if this is the gameMessage and needs text wrapping
-            auto *entityType = ecs.getComponent<EntityType>(entityID);
-            if (entityType && entityType->type == "gameMessage")
-            {
-                // Use text wrapping for game message (max width: 400 pixels)
-                std::vector<std::string> lines = wrapText(uiText->content, font, 400);
-
-                // Calculate total height for centering
-                int lineHeight;
-                TTF_SizeText(font, "A", nullptr, &lineHeight);
-                int totalHeight = lines.size() * lineHeight;
-
-                // Start position (centered vertically)
-                float startY = uiPos.y - totalHeight / 2.0f;
-
-                for (size_t i = 0; i < lines.size(); ++i)
-                {
-                    SDL_Texture *lineTexture = resourceManager->createTextTexture(
-                        lines[i], font, uiText->color);
-
-                    if (lineTexture)
-                    {
-                        int lineWidth, lineHeightActual;
-                        SDL_QueryTexture(lineTexture, nullptr, nullptr, &lineWidth, &lineHeightActual);
-
-                        SDL_Rect destRect = {
-                            static_cast<int>(uiPos.x - lineWidth / 2),
-                            static_cast<int>(startY + i * lineHeight),
-                            lineWidth,
-                            lineHeightActual};
-
-                        SDL_RenderCopy(renderer, lineTexture, nullptr, &destRect);
-                        SDL_DestroyTexture(lineTexture);
-                    }
-                }
-            }
-            else
-            {
-                // Single line rendering for other UI elements
-                SDL_Texture *textTexture = resourceManager->createTextTexture(
-                    uiText->content, font, uiText->color);
-
-                if (textTexture)
-                {
-                    int textWidth, textHeight;
-                    SDL_QueryTexture(textTexture, nullptr, nullptr, &textWidth, &textHeight);
-
-                    SDL_Rect destRect = {
-                        static_cast<int>(uiPos.x),
-                        static_cast<int>(uiPos.y),
-                        textWidth,
-                        textHeight};
-
-                    SDL_RenderCopy(renderer, textTexture, nullptr, &destRect);
-                    SDL_DestroyTexture(textTexture);
-                }
-            }
+            // Unchanged text: a single copy of the composed texture
+            SDL_FRect dest = {static_cast<float>(x), static_cast<float>(y),
+                              static_cast<float>(cache.width), static_cast<float>(cache.height)};
+            uiQueue.push(LAYER_UI, cache.texture, dest, 0.0f, 0.0f,
+                         static_cast<float>(cache.width) / cache.textureWidth,
+                         static_cast<float>(cache.height) / cache.textureHeight);
+        }
+        else
+        {
+            // No render target support (or CPU backend): draw the cached layout as glyph quads
+            queueTextLines(uiQueue, cache, *glyphs, x, y);
+        }
+    }
+}
+
+RenderSystem::TextCache &RenderSystem::updateTextCache(EntityID entityID, const UIText &uiText,
+                                                       const GlyphAtlas &glyphs, int wrapWidth)
+{
+    TextCache &cache = textCaches[entityID];
+
+    bool unchanged = cache.lineHeight > 0 &&
+                     cache.content == uiText.content &&
+                     cache.font == uiText.font &&
+                     cache.color.r == uiText.color.r && cache.color.g == uiText.color.g &&
+                     cache.color.b == uiText.color.b && cache.color.a == uiText.color.a &&
+                     cache.wrapWidth == wrapWidth;
+    if (unchanged)
+        return cache;
+
+    cache.content = uiText.content;
+    cache.font = uiText.font;
+    cache.color = uiText.color;
+    cache.wrapWidth = wrapWidth;
+
+    // Re-run layout only now that the key changed
+    cache.lines.clear();
+    if (wrapWidth > 0)
+        cache.lines = wrapText(uiText.content, glyphs, wrapWidth);
+    else
+        cache.lines.push_back(uiText.content);
+
+    cache.lineHeight = glyphs.lineHeight;
+    cache.lineWidths.clear();
+    cache.width = 0;
+    for (const auto &line : cache.lines)
+    {
+        int lineWidth = glyphs.measureText(line);
+        cache.lineWidths.push_back(lineWidth);
+        cache.width = std::max(cache.width, lineWidth);
+    }
+    cache.height = static_cast<int>(cache.lines.size()) * cache.lineHeight;
+    cache.composed = false;
+
+    return cache;
+}
+
+bool RenderSystem::composeTextTexture(TextCache &cache, const GlyphAtlas &glyphs)
+{
+    if (cache.width <= 0 || cache.height <= 0)
+        return false;
+
+    // Grow the render target only when the text no longer fits
+    if (!cache.texture || cache.width > cache.textureWidth || cache.height > cache.textureHeight)
+    {
+        if (cache.texture)
+            SDL_DestroyTexture(cache.texture);
+
+        cache.textureWidth = std::max(cache.width, cache.textureWidth);
+        cache.textureHeight = std::max(cache.height, cache.textureHeight);
+        cache.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET,
+                                          cache.textureWidth, cache.textureHeight);
+        if (!cache.texture)
+        {
+            cache.textureWidth = cache.textureHeight = 0;
+            return false;
+        }
+        SDL_SetTextureBlendMode(cache.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Texture *previousTarget = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, cache.texture) != 0)
+        return false;
+
+    // Clear to the text color at zero alpha so blended glyph edges don't darken
+    SDL_SetRenderDrawColor(renderer, cache.color.r, cache.color.g, cache.color.b, 0);
+    SDL_RenderClear(renderer);
+    composeQueue.clear();
+    queueTextLines(composeQueue, cache, glyphs, 0, 0);
+    composeQueue.submit(renderer);
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    cache.composed = true;
+    return true;
+}
+
+void RenderSystem::queueTextLines(RenderQueue &queue, const TextCache &cache, const GlyphAtlas &glyphs, int x, int y)
+{
+    for (size_t i = 0; i < cache.lines.size(); ++i)
+    {
+        // Wrapped lines are centered within the block, single lines start at x
+        int lineX = x;
+        if (cache.wrapWidth > 0)
+            lineX += (cache.width - cache.lineWidths[i]) / 2;
+
+        queueText(queue, glyphs, cache.lines[i], lineX, y + static_cast<int>(i) * cache.lineHeight, cache.color);
+    }
+}
+
+void RenderSystem::invalidateRenderTargets(bool deviceLost)
+{
+    for (auto &[entityID, cache] : textCaches)
+    {
+        // After a device reset the old textures are unusable; composing creates new ones
+        if (deviceLost && cache.texture)
+        {
+            SDL_DestroyTexture(cache.texture);
+            cache.texture = nullptr;
+            cache.textureWidth = cache.textureHeight = 0;
+        }
+        cache.composed = false;
+    }
+
+    backend->invalidate(deviceLost);
+
+    // Atlas pages, glyph atlases and loaded textures died with the device too
+    if (deviceLost)
+        resourceManager->recreateDeviceTextures();
+}
+
+void RenderSystem::pruneTextCaches(const RenderSnapshot &snapshot)
+{
+    // Drop caches of UI entities that no longer appear in the snapshot
+    for (auto it = textCaches.begin(); it != textCaches.end();)
+    {
+        bool present = false;
+        for (size_t i = 0; i < snapshot.uiTextCount && !present; ++i)
+        {
+            present = snapshot.uiTexts[i].entityID == it->first;
+        }
+
+        if (!present)
+        {
+            if (it->second.texture)
+                SDL_DestroyTexture(it->second.texture);
+            it = textCaches.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
 }
 
-std::vector<std::string> RenderSystem::wrapText(const std::string &text, TTF_Font *font, int maxWidth)
+std::vector<std::string> RenderSystem::wrapText(const std::string &text, const GlyphAtlas &glyphs, int maxWidth)
 {
     std::vector<std::string> lines;
     std::istringstream words(text);
@@ -243,8 +511,7 @@ std::vector<std::string> RenderSystem::wrapText(const std::string &text, TTF_Fon
     {
         std::string testLine = currentLine.empty() ? word : currentLine + " " + word;
 
-        int textWidth;
-        TTF_SizeText(font, testLine.c_str(), &textWidth, nullptr);
+        int textWidth = glyphs.measureText(testLine);
 
         if (textWidth <= maxWidth)
         {
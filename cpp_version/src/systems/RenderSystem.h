@@ -1,24 +1,122 @@
 #pragma once
 #include "System.h"
+#include "RenderQueue.h"
+#include "RenderSnapshot.h"
+#include "RenderBackend.h"
+#include "../core/SpatialGrid.h"
+#include "../core/Camera.h"
+#include "../components/Components.h"
+#include "../managers/ResourceHandles.h"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
 class ResourceManager; // Forward declaration
+struct GlyphAtlas;
+struct UIText;
+struct Transform;
 
 class RenderSystem : public System
 {
 private:
     SDL_Renderer *renderer;
     ResourceManager *resourceManager;
+    std::unique_ptr<RenderBackend> backend;
+
+    // Viewport culling: sprite bounds are indexed each snapshot and queried against the
+    // camera's world-space view rectangle
+    SpatialGrid spriteGrid;
+    std::vector<EntityID> visibleEntities;
+    SDL_FRect viewRect = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    // UI text of this entity type is wrapped and centered on its position (the game message)
+    EntityTypeId centeredTextType = INVALID_ENTITY_TYPE;
+    static constexpr int CENTERED_TEXT_WRAP_WIDTH = 400;
+
+    // UI commands built on the render side, and a scratch queue for composing cached text
+    RenderQueue uiQueue;
+    RenderQueue composeQueue;
+
+    // Laid-out lines and composed texture of one UIText, reused until any key field changes
+    struct TextCache
+    {
+        // Cache key
+        std::string content;
+        FontHandle font;
+        SDL_Color color = {0, 0, 0, 0};
+        int wrapWidth = 0;
+
+        // Layout
+        std::vector<std::string> lines;
+        std::vector<int> lineWidths;
+        int width = 0, height = 0, lineHeight = 0;
+
+        // Composed render target (may be larger than width x height)
+        SDL_Texture *texture = nullptr;
+        int textureWidth = 0, textureHeight = 0;
+        bool composed = false;
+    };
+    std::unordered_map<EntityID, TextCache> textCaches;
+
+    // Dynamic resolution: the world pass scale follows the frame-time budget with hysteresis
+    struct ResolutionScaling
+    {
+        bool enabled = false;
+        float minScale = 0.5f;
+        float step = 0.1f;
+        float scale = 1.0f;
+        float averageWorkTime = 0.0f; // Exponential moving average, seconds
+        int framesOverBudget = 0;
+        int framesUnderBudget = 0;
+        int cooldownFrames = 0;       // Frames to hold after a change before reacting again
+    };
+    ResolutionScaling resolution;
+    float lastPresentTime = 0.0f;     // Seconds spent in backend->endFrame() last frame
 
 public:
-    RenderSystem(SDL_Renderer *renderer, ResourceManager *rm);
-    void update(ECS &ecs, GameManager &gameManager, float fps);
+    RenderSystem(SDL_Renderer *renderer, ResourceManager *rm, std::unique_ptr<RenderBackend> backend);
+    ~RenderSystem();
+
+    // Simulation side: capture sprites and UI text into a snapshot without touching SDL.
+    // alpha is the fraction of a fixed tick elapsed since the last simulation step;
+    // the camera is re-centred on its interpolated target so scrolling is smooth too.
+    void buildSnapshot(ECS &ecs, RenderSnapshot &snapshot, const Camera &camera, float alpha = 1.0f);
+
+    // Render side: draw a snapshot (must run on the thread that owns the renderer)
+    void renderSnapshot(const RenderSnapshot &snapshot);
+
+    RenderBackend *getBackend() const { return backend.get(); }
+    void setCenteredTextType(EntityTypeId type) { centeredTextType = type; }
+
+    // Dynamic resolution scaling of the world pass (UI always renders at native resolution)
+    void configureResolutionScaling(bool enabled, float minScale, float step);
+    void reportFrameTime(float workSeconds, float budgetSeconds);
+    float getWorldScale() const { return resolution.scale; }
+    float getLastPresentTime() const { return lastPresentTime; }
+
+    // The renderer dropped the contents of its render targets (SDL_RENDER_TARGETS_RESET), or
+    // every texture with them (SDL_RENDER_DEVICE_RESET); composed text is redrawn next frame
+    void invalidateRenderTargets(bool deviceLost);
 
 private:
-    void renderSprites(ECS &ecs);
-    void renderUI(ECS &ecs, GameManager &gameManager, float fps);
-    std::vector<std::string> wrapText(const std::string &text, TTF_Font *font, int maxWidth);
+    void snapshotSprites(ECS &ecs, RenderSnapshot &snapshot, float alpha);
+    static void interpolatePosition(ECS &ecs, EntityID entityID, const Transform &transform, float alpha,
+                                    float &x, float &y);
+    void snapshotUI(ECS &ecs, RenderSnapshot &snapshot);
+    static Uint64 hashSnapshot(const RenderSnapshot &snapshot);
+    void queueText(RenderQueue &queue, const GlyphAtlas &glyphs, const std::string &text,
+                   int x, int y, SDL_Color color);
+    void renderUI(const RenderSnapshot &snapshot);
+    static SDL_FRect toFRect(const SDL_Rect &rect)
+    {
+        return {static_cast<float>(rect.x), static_cast<float>(rect.y),
+                static_cast<float>(rect.w), static_cast<float>(rect.h)};
+    }
+    std::vector<std::string> wrapText(const std::string &text, const GlyphAtlas &glyphs, int maxWidth);
+    TextCache &updateTextCache(EntityID entityID, const UIText &uiText, const GlyphAtlas &glyphs, int wrapWidth);
+    bool composeTextTexture(TextCache &cache, const GlyphAtlas &glyphs);
+    void queueTextLines(RenderQueue &queue, const TextCache &cache, const GlyphAtlas &glyphs, int x, int y);
+    void pruneTextCaches(const RenderSnapshot &snapshot);
 };
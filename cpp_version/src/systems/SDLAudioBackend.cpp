@@ -0,0 +1,69 @@
+#include "SDLAudioBackend.h"
+#include "MusicStreamer.h"
+#include <iostream>
+
+bool SDLAudioBackend::open(int frequency, int chunkSize)
+{
+    if (Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, 2, chunkSize) < 0)
+    {
+        std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SDLAudioBackend::close()
+{
+    Mix_CloseAudio();
+}
+
+void SDLAudioBackend::allocateVoices(int count)
+{
+    Mix_AllocateChannels(count);
+}
+
+bool SDLAudioBackend::startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right)
+{
+    // Channel settings persist, so every play sets both volume and panning (before
+    // starting, so the first mixed buffer already uses them)
+    Mix_Volume(voice, volume);
+    Mix_SetPanning(voice, left, right); // 255/255 removes the panning effect
+    return Mix_PlayChannel(voice, chunk, 0) >= 0; // 0 = play once
+}
+
+void SDLAudioBackend::haltVoice(int voice)
+{
+    Mix_HaltChannel(voice);
+}
+
+bool SDLAudioBackend::isVoicePlaying(int voice) const
+{
+    return Mix_Playing(voice) != 0;
+}
+
+bool SDLAudioBackend::setMusicSource(MusicStreamer *source)
+{
+    if (!source)
+    {
+        Mix_HookMusic(nullptr, nullptr);
+        return true;
+    }
+
+    // The hook writes straight into SDL_mixer's output buffer
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    if (format != AUDIO_S16SYS || channels != 2)
+    {
+        std::cerr << "Music streaming needs 16-bit stereo output, got format 0x" << std::hex << format << std::dec
+                  << " with " << channels << " channels" << std::endl;
+        return false;
+    }
+
+    // Runs on SDL's audio thread; the channels are mixed on top of the music afterwards
+    Mix_HookMusic([](void *userdata, Uint8 *stream, int length) {
+        static_cast<MusicStreamer *>(userdata)->mix(reinterpret_cast<Sint16 *>(stream),
+                                                    static_cast<size_t>(length) / (2 * sizeof(Sint16)));
+    }, source);
+    return true;
+}
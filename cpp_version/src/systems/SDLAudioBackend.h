@@ -0,0 +1,20 @@
+#pragma once
+#include "AudioBackend.h"
+
+// SDL_mixer on the system's sound device; voices are mixer channels
+class SDLAudioBackend : public AudioBackend
+{
+public:
+    bool open(int frequency, int chunkSize) override;
+    void close() override;
+
+    void allocateVoices(int count) override;
+    bool startVoice(int voice, Mix_Chunk *chunk, int volume, Uint8 left, Uint8 right) override;
+    void haltVoice(int voice) override;
+    bool isVoicePlaying(int voice) const override;
+
+    // Installed as SDL_mixer's music hook
+    bool setMusicSource(MusicStreamer *source) override;
+
+    const char *getName() const override { return "sdl_mixer"; }
+};
@@ -0,0 +1,87 @@
+#include "SDLRenderBackend.h"
+#include <cmath>
+#include <iostream>
+
+SDLRenderBackend::~SDLRenderBackend()
+{
+    if (sceneTarget)
+        SDL_DestroyTexture(sceneTarget);
+}
+
+void SDLRenderBackend::beginFrame(SDL_Color clearColor)
+{
+    SDL_SetRenderDrawColor(renderer, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    SDL_RenderClear(renderer);
+}
+
+void SDLRenderBackend::submit(const RenderQueue &queue)
+{
+    queue.submit(renderer);
+}
+
+void SDLRenderBackend::beginScaledPass(float scale, SDL_Color clearColor)
+{
+    scaledPassActive = false;
+    if (scale >= 1.0f)
+        return;
+
+    int outputWidth = 0, outputHeight = 0;
+    if (SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) != 0)
+        return;
+
+    if (!sceneTarget || outputWidth != sceneTargetWidth || outputHeight != sceneTargetHeight)
+    {
+        if (sceneTarget)
+            SDL_DestroyTexture(sceneTarget);
+
+        sceneTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET,
+                                        outputWidth, outputHeight);
+        if (!sceneTarget)
+        {
+            std::cerr << "Failed to create scaled scene target! SDL_Error: " << SDL_GetError() << std::endl;
+            sceneTargetWidth = sceneTargetHeight = 0;
+            return;
+        }
+        SDL_SetTextureScaleMode(sceneTarget, SDL_ScaleModeLinear);
+        sceneTargetWidth = outputWidth;
+        sceneTargetHeight = outputHeight;
+    }
+
+    if (SDL_SetRenderTarget(renderer, sceneTarget) != 0)
+        return;
+
+    // World commands stay in screen coordinates; the renderer scale shrinks them into the target
+    sceneRect = {0, 0,
+                 static_cast<int>(std::ceil(outputWidth * scale)),
+                 static_cast<int>(std::ceil(outputHeight * scale))};
+    SDL_SetRenderDrawColor(renderer, clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    SDL_RenderClear(renderer);
+    SDL_RenderSetScale(renderer, scale, scale);
+    scaledPassActive = true;
+}
+
+void SDLRenderBackend::endScaledPass()
+{
+    if (!scaledPassActive)
+        return;
+
+    // Back to the window and upscale the low-resolution scene with linear filtering
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    SDL_SetRenderTarget(renderer, nullptr);
+    SDL_RenderCopy(renderer, sceneTarget, &sceneRect, nullptr);
+    scaledPassActive = false;
+}
+
+void SDLRenderBackend::endFrame()
+{
+    SDL_RenderPresent(renderer);
+}
+
+void SDLRenderBackend::invalidate(bool deviceLost)
+{
+    // Recreated at output size by the next scaled pass
+    if (sceneTarget)
+        SDL_DestroyTexture(sceneTarget);
+    sceneTarget = nullptr;
+    sceneTargetWidth = sceneTargetHeight = 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "RenderBackend.h"
+#include <SDL2/SDL.h>
+
+// Backend that submits draw commands to an SDL_Renderer (normally GPU accelerated)
+class SDLRenderBackend : public RenderBackend
+{
+private:
+    SDL_Renderer *renderer;
+
+    // Offscreen target for scaled passes, allocated at output size so scale changes never reallocate
+    SDL_Texture *sceneTarget = nullptr;
+    int sceneTargetWidth = 0, sceneTargetHeight = 0;
+    SDL_Rect sceneRect = {0, 0, 0, 0}; // Part of sceneTarget used at the current scale
+    bool scaledPassActive = false;
+
+public:
+    SDLRenderBackend(SDL_Renderer *renderer) : renderer(renderer) {}
+    ~SDLRenderBackend();
+
+    void beginFrame(SDL_Color clearColor) override;
+    void submit(const RenderQueue &queue) override;
+    void beginScaledPass(float scale, SDL_Color clearColor) override;
+    void endScaledPass() override;
+    void endFrame() override;
+    void invalidate(bool deviceLost) override;
+    bool supportsRenderTargets() const override { return true; }
+    const char *getName() const override { return "sdl"; }
+};
@@ -7,10 +7,15 @@
 #include "MovementSystem.h"
 #include "AnimationSystem.h"
 #include "RenderSystem.h"
+#include "SDLRenderBackend.h"
+#include "CPURenderBackend.h"
 #include "AudioSystem.h"
+#include "SDLAudioBackend.h"
+#include "OfflineAudioBackend.h"
 #include "MobSpawningSystem.h"
 #include "CollisionSystem.h"
 #include "BoundarySystem.h"
+#include "ChunkStreamingSystem.h"
 
 // Forward declarations for systems not yet implemented will be added in Phase 4
 // class HudSystem;
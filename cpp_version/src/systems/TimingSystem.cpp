@@ -1,19 +1,63 @@
 #include "TimingSystem.h"
+#include <algorithm>
+#include <cmath>
 #include <thread>
 
-TimingSystem::TimingSystem()
-    : frameCount(0), currentFPS(60.0f)
+namespace
 {
-    lastTime = std::chrono::high_resolution_clock::now();
+    constexpr std::chrono::microseconds MIN_SPIN_MARGIN(500);
+    constexpr std::chrono::microseconds MAX_SPIN_MARGIN(4000);
+}
+
+TimingSystem::TimingSystem(PacingMode mode, float targetFPS)
+    : frameCount(0), currentFPS(60.0f), pacingMode(mode), targetFPS(0.0f), targetFrameTime(0.0f),
+      spinMargin(std::chrono::microseconds(1000)), pacingError(0.0f), maxPacingError(0.0f),
+      windowMaxPacingError(0.0f), skipNextInterval(true), budgetFrameTime(0.0f), framesOverBudget(0),
+      windowFramesOverBudget(0)
+{
+    // skipNextInterval: the first interval covers startup, not a frame
+    lastTime = Clock::now();
     fpsCounterTime = lastTime;
+    windowStart = lastTime;
+    nextDeadline = lastTime;
+    setPacing(mode, targetFPS);
+}
+
+void TimingSystem::setPacing(PacingMode mode, float fps)
+{
+    pacingMode = mode;
+    targetFPS = mode == PacingMode::UNLOCKED ? 0.0f : std::max(fps, 1.0f);
+    targetFrameTime = targetFPS > 0.0f ? 1.0f / targetFPS : 0.0f;
+    budgetFrameTime = 1.0f / std::max(fps, 1.0f);
+    nextDeadline = Clock::now();
+}
+
+void TimingSystem::resumeAfterIdle()
+{
+    // The wait is not frame time: the next delta counts one frame from here,
+    // so waking runs a single tick instead of handing the whole wait to the
+    // simulation and audio
+    skipNextInterval = true;
+    nextDeadline = Clock::now();
+    lastTime = nextDeadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(budgetFrameTime));
 }
 
 float TimingSystem::update()
 {
-    auto currentTime = std::chrono::high_resolution_clock::now();
+    auto currentTime = Clock::now();
     auto deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
     lastTime = currentTime;
 
+    // How far this frame's interval was from the one we asked for
+    pacingError = targetFrameTime > 0.0f && !skipNextInterval ? (deltaTime - targetFrameTime) * 1000.0f : 0.0f;
+    if (!skipNextInterval)
+    {
+        frameTimes.record(deltaTime);
+        windowFrameTimes.record(deltaTime);
+    }
+    skipNextInterval = false;
+    windowMaxPacingError = std::max(windowMaxPacingError, std::fabs(pacingError));
+
     // Update FPS counter
     frameCount++;
     auto fpsElapsed = std::chrono::duration<float>(currentTime - fpsCounterTime).count();
@@ -22,19 +66,119 @@ float TimingSystem::update()
         currentFPS = frameCount / fpsElapsed;
         frameCount = 0;
         fpsCounterTime = currentTime;
+        maxPacingError = windowMaxPacingError;
+        windowMaxPacingError = 0.0f;
+    }
+
+    // Percentiles need more samples than one FPS window holds
+    if (std::chrono::duration<float>(currentTime - windowStart).count() >= OVERLAY_WINDOW_SECONDS)
+    {
+        recentFrameTimes = windowFrameTimes.getSummary();
+        recentFrameTimes.overBudget = windowFramesOverBudget;
+        windowFrameTimes.reset();
+        windowFramesOverBudget = 0;
+        windowStart = currentTime;
     }
 
     return deltaTime;
 }
 
+void TimingSystem::recordFrameWork(float seconds)
+{
+    if (seconds > budgetFrameTime)
+    {
+        framesOverBudget++;
+        windowFramesOverBudget++;
+    }
+}
+
+FrameTimeSummary TimingSystem::getFrameTimeSummary() const
+{
+    FrameTimeSummary summary = frameTimes.getSummary();
+    summary.overBudget = framesOverBudget;
+    return summary;
+}
+
 void TimingSystem::limitFrameRate()
 {
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    auto frameTime = std::chrono::duration<float>(currentTime - lastTime).count();
+    // VSYNC is paced by SDL_RenderPresent, UNLOCKED not at all
+    if (pacingMode != PacingMode::FIXED)
+        return;
+
+    auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFPS));
+
+    // Deadlines advance by exact periods so rounding never accumulates into drift;
+    // after a long stall, resynchronise instead of rushing frames to catch up
+    auto now = Clock::now();
+    nextDeadline += period;
+    if (nextDeadline < now - period)
+        nextDeadline = now;
+
+    // Coarse sleep: cheap but overshoots by up to a scheduler quantum
+    if (nextDeadline - now > spinMargin)
+    {
+        auto wakeTarget = nextDeadline - spinMargin;
+        std::this_thread::sleep_until(wakeTarget);
+        now = Clock::now();
 
-    if (frameTime < targetFrameTime)
+        auto overshoot = now - wakeTarget;
+        auto margin = std::max<Clock::duration>(spinMargin - spinMargin / 8, overshoot * 2);
+        spinMargin = std::clamp<Clock::duration>(margin, MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+    }
+
+    // Spin the remainder against steady_clock for sub-millisecond accuracy
+    while (now < nextDeadline)
+    {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+}
+
+bool TimingSystem::parsePacingMode(const std::string &name, PacingMode &mode)
+{
+    if (name == "vsync")
+        mode = PacingMode::VSYNC;
+    else if (name == "fixed")
+        mode = PacingMode::FIXED;
+    else if (name == "unlocked")
+        mode = PacingMode::UNLOCKED;
+    else
+        return false;
+    return true;
+}
+
+const char *TimingSystem::getPhaseName(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::INPUT:
+        return "input";
+    case FramePhase::SIMULATE:
+        return "simulate";
+    case FramePhase::UI:
+        return "ui";
+    case FramePhase::RENDER:
+        return "render";
+    case FramePhase::PRESENT:
+        return "present";
+    case FramePhase::SLEEP:
+        return "sleep";
+    case FramePhase::COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+const char *TimingSystem::getPacingModeName(PacingMode mode)
+{
+    switch (mode)
     {
-        float sleepTime = targetFrameTime - frameTime;
-        std::this_thread::sleep_for(std::chrono::duration<float>(sleepTime));
+    case PacingMode::VSYNC:
+        return "vsync";
+    case PacingMode::FIXED:
+        return "fixed";
+    case PacingMode::UNLOCKED:
+        return "unlocked";
     }
+    return "unknown";
 }
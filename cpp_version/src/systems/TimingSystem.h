@@ -1,29 +1,113 @@
 #pragma once
 #include "System.h"
+#include "FrameHistogram.h"
 #include <chrono>
+#include <string>
+
+// How the main loop paces frame delivery
+enum class PacingMode
+{
+    VSYNC,    // SDL_RenderPresent blocks on the display refresh
+    FIXED,    // Deadline scheduler at a fixed target rate (e.g. 60, 144, 240 Hz)
+    UNLOCKED  // No limiting, render as fast as possible
+};
+
+// Stages of a frame with their own duration histograms
+enum class FramePhase
+{
+    INPUT,    // Event polling and keyboard sampling
+    SIMULATE, // Fixed ticks and snapshot building (on the simulation thread when pipelined)
+    UI,       // Overlay text updates
+    RENDER,   // Draw submission up to present
+    PRESENT,  // SDL_RenderPresent / frame output (includes vsync blocking)
+    SLEEP,    // Waiting for the next frame deadline
+    COUNT
+};
 
 class TimingSystem : public System
 {
 private:
-    std::chrono::high_resolution_clock::time_point lastTime;
-    std::chrono::high_resolution_clock::time_point fpsCounterTime;
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point lastTime;
+    Clock::time_point fpsCounterTime;
+    Clock::time_point nextDeadline;
     int frameCount;
     float currentFPS;
-    const float targetFPS = 60.0f;
-    const float targetFrameTime = 1.0f / targetFPS;
+
+    PacingMode pacingMode;
+    float targetFPS;
+    float targetFrameTime;
+
+    // Coarse sleep stops this far before the deadline and spins the rest;
+    // grows with the worst sleep overshoot the OS has shown us
+    Clock::duration spinMargin;
+
+    // Frame interval minus the target interval, in milliseconds
+    float pacingError;
+    float maxPacingError; // Largest |pacingError| over the last FPS window
+    float windowMaxPacingError;
+    bool skipNextInterval; // The loop was idle; the next interval says nothing about pacing
+
+    // Frame-time distribution: frame intervals over the whole run and per phase,
+    // plus a rolling window published for the overlay
+    static constexpr float OVERLAY_WINDOW_SECONDS = 5.0f;
+    FrameHistogram frameTimes;
+    FrameHistogram phaseTimes[static_cast<int>(FramePhase::COUNT)];
+    FrameHistogram windowFrameTimes;
+    FrameTimeSummary recentFrameTimes; // Last complete overlay window
+    Clock::time_point windowStart;
+
+    // Frames whose work (everything but pacing and present) exceeded the frame budget
+    float budgetFrameTime; // 1 / requested rate, also when unlocked
+    Uint64 framesOverBudget;
+    Uint64 windowFramesOverBudget;
 
 public:
-    TimingSystem();
+    TimingSystem(PacingMode mode = PacingMode::FIXED, float targetFPS = 60.0f);
 
     // Returns delta time in seconds
     float update();
 
-    // Limit frame rate to 60 FPS
+    // Wait until the next frame deadline (FIXED mode only)
     void limitFrameRate();
 
+    void setPacing(PacingMode mode, float targetFPS);
+
+    // Call after the loop blocked waiting for events instead of pacing a frame;
+    // the next update() returns about one frame, not the time spent waiting
+    void resumeAfterIdle();
+    PacingMode getPacingMode() const { return pacingMode; }
+
     // Get current FPS for display
     float getFPS() const { return currentFPS; }
 
-    // Get target frame time
+    // Seconds since the current frame started (update() was called)
+    float getFrameElapsed() const { return std::chrono::duration<float>(Clock::now() - lastTime).count(); }
+
+    // Get target frame time (0 when unlocked)
     float getTargetFrameTime() const { return targetFrameTime; }
+
+    // Pacing error of the last frame and the worst one in the last second, in milliseconds
+    float getPacingError() const { return pacingError; }
+    float getMaxPacingError() const { return maxPacingError; }
+
+    // Add one frame's time in a phase
+    void recordPhase(FramePhase phase, float seconds) { phaseTimes[static_cast<int>(phase)].record(seconds); }
+
+    // Report the frame's work time (excluding pacing and present); counts it if over budget
+    void recordFrameWork(float seconds);
+
+    // Whole-run distributions for the exit summary
+    FrameTimeSummary getFrameTimeSummary() const;
+    const FrameHistogram &getPhaseTimes(FramePhase phase) const { return phaseTimes[static_cast<int>(phase)]; }
+    float getFrameBudget() const { return budgetFrameTime; }
+
+    // Frame times over the last complete overlay window (count 0 until the first one ends)
+    const FrameTimeSummary &getRecentFrameTimes() const { return recentFrameTimes; }
+
+    static const char *getPhaseName(FramePhase phase);
+
+    static bool parsePacingMode(const std::string &name, PacingMode &mode);
+    static const char *getPacingModeName(PacingMode mode);
 };
@@ -0,0 +1,180 @@
+// Packs art/ and fonts/ into a single pre-decoded asset bundle for the game's
+// --bundle option. Images are stored as RGBA32 pixels and sound effects as PCM in
+// the mixer's output format, so loading them at runtime is a copy from the mapping.
+#include "AssetBundle.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Must match AudioSystem::initialize(); the game falls back to decoding the file
+// at runtime if the mixer was opened with a different format
+static const int MIXER_FREQUENCY = 44100;
+static const int MIXER_CHANNELS = 2;
+static const int MIXER_CHUNK_SIZE = 2048;
+
+static const char *BUNDLED_DIRECTORIES[] = {"art", "fonts"};
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options] OUTPUT\n"
+              << "  --root DIR   Directory containing art/ and fonts/ (default: " << ASSET_PATH << ")\n";
+}
+
+static bool readFile(const fs::path &path, std::vector<Uint8> &bytes)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    bytes.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    return file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size())).good();
+}
+
+static std::string lowerExtension(const fs::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string root = ASSET_PATH;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--root") == 0 && i + 1 < argc)
+        {
+            root = argv[++i];
+        }
+        else if (argv[i][0] != '-' && output.empty())
+        {
+            output = argv[i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (output.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (root.empty())
+        root = ".";
+
+    // Sound effects are converted by opening the mixer on the dummy audio driver
+    SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_AUDIO) < 0)
+    {
+        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    IMG_Init(IMG_INIT_PNG);
+    if (Mix_OpenAudio(MIXER_FREQUENCY, MIX_DEFAULT_FORMAT, MIXER_CHANNELS, MIXER_CHUNK_SIZE) < 0)
+    {
+        std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
+        SDL_Quit();
+        return 1;
+    }
+    int frequency = 0, channels = 0;
+    Uint16 format = 0;
+    Mix_QuerySpec(&frequency, &format, &channels);
+
+    // Sorted so the bundle is byte-for-byte reproducible
+    std::vector<fs::path> files;
+    for (const char *directory : BUNDLED_DIRECTORIES)
+    {
+        fs::path base = fs::path(root) / directory;
+        std::error_code error;
+        for (fs::recursive_directory_iterator it(base, error), end; !error && it != end; it.increment(error))
+        {
+            if (it->is_regular_file())
+                files.push_back(it->path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    AssetBundleWriter writer;
+    int textures = 0, sounds = 0, blobs = 0, failures = 0;
+    for (const auto &file : files)
+    {
+        // Entry names are the paths entities.json uses
+        std::string name = fs::relative(file, root).generic_string();
+        std::string extension = lowerExtension(file);
+
+        if (extension == ".png" || extension == ".jpg" || extension == ".bmp")
+        {
+            SDL_Surface *loaded = IMG_Load(file.string().c_str());
+            SDL_Surface *rgba = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+            if (loaded)
+                SDL_FreeSurface(loaded);
+            if (!rgba || !writer.addTexture(name, rgba))
+            {
+                std::cerr << "Failed to decode image: " << file << " - " << IMG_GetError() << std::endl;
+                failures++;
+            }
+            else
+            {
+                textures++;
+            }
+            if (rgba)
+                SDL_FreeSurface(rgba);
+        }
+        else if (extension == ".wav")
+        {
+            Mix_Chunk *chunk = Mix_LoadWAV(file.string().c_str());
+            if (!chunk)
+            {
+                std::cerr << "Failed to decode sound: " << file << " - " << Mix_GetError() << std::endl;
+                failures++;
+                continue;
+            }
+            writer.addPCM(name, chunk->abuf, chunk->alen, frequency, format, channels);
+            Mix_FreeChunk(chunk);
+            sounds++;
+        }
+        else if (extension == ".ogg" || extension == ".mp3" || extension == ".ttf" || extension == ".otf")
+        {
+            // Music is streamed and fonts are parsed by FreeType: both are kept as file bytes
+            std::vector<Uint8> bytes;
+            if (!readFile(file, bytes))
+            {
+                std::cerr << "Failed to read file: " << file << std::endl;
+                failures++;
+                continue;
+            }
+            writer.addBlob(name, std::move(bytes));
+            blobs++;
+        }
+        // Anything else (Godot .import files, licenses) is not used by the game
+    }
+
+    Mix_CloseAudio();
+    IMG_Quit();
+    SDL_Quit();
+
+    if (failures > 0 || !writer.write(output))
+    {
+        std::cerr << "Asset bundle not written (" << failures << " asset(s) failed)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Bundled " << writer.getEntryCount() << " assets (" << textures << " textures, "
+              << sounds << " sounds, " << blobs << " files) into " << output << std::endl;
+    return 0;
+}